@@ -138,26 +138,25 @@ https://media.geeksforgeeks.org/wp-content/uploads/20230422155818/flowchart-of-c
 
 */
 
-// if statement program
+#include <cstdlib>
 #include <iostream>
+#include "commands.h"
+#include "demos.h"
 using namespace std;
-int main() 
+
+// if statement program
+static void if_statement(int age)
 {
-    int age = 19;
     if (age == 19) 
     {
         cout << "Then this statement will be executed";
     }
-    return 0;
+    cout << endl;
 }
 
 // if-else statement program
-#include <iostream>
-using namespace std;
-
-int main() 
+static void if_else_statement(int n)
 {
-    int n = 5;
     // Using if-else to determine if the number is positive
     // or non positive
     if (n > 0) 
@@ -168,17 +167,12 @@ int main()
     {
         cout << "number is non-positive.";
     }
-    return 0;
+    cout << endl;
 }
 
 // if-else if ladder
-#include <iostream>
-using namespace std;
-
-int main() 
+static void if_else_if_ladder(int age)
 {
-    int age = 18;
-
     // if this condition is true child is printed
     if (age < 13) 
     {
@@ -198,17 +192,12 @@ int main()
     {
         cout << "adult";
     }
-    return 0;
+    cout << endl;
 }
 
 // nested if-else statement
-#include <iostream>
-using namespace std;
-
-int main() 
+static void nested_if_else(int n)
 {
-    int n = 44;
-  
     // to check if n is positive
     if (n > 0) 
     {
@@ -233,49 +222,76 @@ int main()
     {
         cout << "the number is negative";
     }
-    return 0;
+    cout << endl;
 }
 
-// switch case statement program
-#include <iostream>
-using namespace std;
+// switch case statement program, with the cases in a CommandTable: each
+// input character is a command code, so a case is one array lookup and
+// adding one is one more table row
+typedef void (*CaseHandler)();
 
-int main() {
-    char c = 'B';
-    switch (c) 
-    {
-        
-    // if the input character is A then print GFG
-    case 'A':
-        cout << "GFG";
-        break;
+// if the input character is A then print GFG
+static void print_gfg()
+{
+    cout << "GFG";
+}
 
-    // if the input character is B then print
-    // GeeksforGeeks
-    case 'B':
-        cout << "GeeksforGeeks";
-        break;
-    default:
-        
+// if the input character is B then print GeeksforGeeks
+static void print_geeksforgeeks()
+{
+    cout << "GeeksforGeeks";
+}
+
+static constexpr auto cases = make_command_table<CaseHandler>({
+    {'A', "A", "GFG", print_gfg},
+    {'B', "B", "GeeksforGeeks", print_geeksforgeeks},
+});
+
+static void switch_statement(char c)
+{
+    int i = cases.find(c);
+    if (i >= 0)
+    {
+        cases[i].handler();
+    }
+    else
+    {
         // if the input character is invalid then print
         // invalid input
         cout << "invalid input";
     }
-    return 0;
+    cout << endl;
 }
 
 // ternary operator program
-#include <iostream>
-using namespace std;
-
-int main() 
+static void ternary_operator(int num1, int num2)
 {
-    int num1 = 10, num2 = 40;
     int max;
   
     // if the condition is true then num1 will be printed
     // else num2 will printed
     max = (num1 > num2) ? num1 : num2;
-    cout << max;
+    cout << max << endl;
+}
+
+// runs the programs above in order, each on its own example value, or
+// all on n when one is given: classify [n]
+int classify_main(int argc, char** argv)
+{
+    bool given = argc > 1;
+    int n = given ? atoi(argv[1]) : 0;
+    if_statement(given ? n : 19);
+    if_else_statement(given ? n : 5);
+    if_else_if_ladder(given ? n : 18);
+    nested_if_else(given ? n : 44);
+    switch_statement('B');
+    ternary_operator(given ? n : 10, 40);
     return 0;
-}
\ No newline at end of file
+}
+
+#ifndef DEMOS_NO_MAIN
+int main(int argc, char** argv)
+{
+    return classify_main(argc, argv);
+}
+#endif
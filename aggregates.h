@@ -0,0 +1,278 @@
+// Class-wide aggregates kept up to date as records change.
+//
+// Each definition names a field of the student record, an optional
+// inclusive range of values it applies to (so "students with a total
+// above 300" is a Count over Total from 301), and a kind. The registry
+// feeds every insert, update and delete through here as a delta, so
+// reading an aggregate is O(1) however many students there are, instead
+// of a rescan; with n aggregates defined, each change costs O(n).
+//
+// Sum, Count and Mean are exact under any sequence of changes. Min and Max
+// keep the current extreme and how many rows hold it; deleting the last
+// of them leaves the aggregate stale, and the next read rescans the rows
+// once. Histogram buckets count values by fixed-width ranges, with values
+// below the first bucket or past the last clamped into it.
+#ifndef AGGREGATES_H
+#define AGGREGATES_H
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+enum class StudentField
+{
+    Mark1,
+    Mark2,
+    Mark3,
+    Mark4,
+    Total,
+    RollNo
+};
+
+enum class AggregateKind
+{
+    Sum,
+    Count,
+    Mean,
+    Min,
+    Max,
+    Histogram
+};
+
+struct AggregateSpec
+{
+    AggregateKind kind = AggregateKind::Count;
+    StudentField field = StudentField::Total;
+    int low = INT_MIN;  // only values in [low, high] are aggregated
+    int high = INT_MAX;
+    // Histogram: bucket i counts values in [low + i * width, low + (i + 1) * width)
+    int bucket_width = 10;
+    size_t buckets = 0;
+};
+
+inline int student_field(StudentField f, int roll_no, const int* marks)
+{
+    switch (f)
+    {
+    case StudentField::Mark1:
+    case StudentField::Mark2:
+    case StudentField::Mark3:
+    case StudentField::Mark4:
+        return marks[(int)f - (int)StudentField::Mark1];
+    case StudentField::Total:
+        return marks[0] + marks[1] + marks[2] + marks[3];
+    default:
+        return roll_no;
+    }
+}
+
+class MaterializedAggregates
+{
+public:
+    // returns the aggregate's id; for_each_row(f) must call f(roll_no,
+    // marks) for every existing row, which are aggregated straight away
+    template <class Rows>
+    size_t define(const AggregateSpec& spec, Rows for_each_row)
+    {
+        State s;
+        s.spec = spec;
+        if (spec.kind == AggregateKind::Histogram)
+        {
+            s.buckets.assign(spec.buckets ? spec.buckets : 1, 0);
+        }
+        for_each_row([&](int roll_no, const int* marks)
+        {
+            apply(s, student_field(spec.field, roll_no, marks), 1);
+        });
+        states.push_back(s);
+        return states.size() - 1;
+    }
+
+    size_t size() const
+    {
+        return states.size();
+    }
+
+    const AggregateSpec& spec(size_t id) const
+    {
+        return states[id].spec;
+    }
+
+    // forgets every row, keeping the definitions
+    void reset()
+    {
+        for (State& s : states)
+        {
+            reset_state(s);
+        }
+    }
+
+    void insert(int roll_no, const int* marks)
+    {
+        for (State& s : states)
+        {
+            apply(s, student_field(s.spec.field, roll_no, marks), 1);
+        }
+    }
+
+    void erase(int roll_no, const int* marks)
+    {
+        for (State& s : states)
+        {
+            apply(s, student_field(s.spec.field, roll_no, marks), -1);
+        }
+    }
+
+    void update(int roll_no, const int* old_marks, const int* new_marks)
+    {
+        for (State& s : states)
+        {
+            int before = student_field(s.spec.field, roll_no, old_marks);
+            int after = student_field(s.spec.field, roll_no, new_marks);
+            if (before != after)
+            {
+                apply(s, before, -1);
+                apply(s, after, 1);
+            }
+        }
+    }
+
+    // rows in range
+    long long count(size_t id) const
+    {
+        return states[id].count;
+    }
+
+    // Sum and Count give their total, Mean its truncated mean, Min and Max
+    // the extreme (0 when no rows are in range); for_each_row(f) must call
+    // f(roll_no, marks) for every row, and is only used to refresh a
+    // stale Min or Max
+    template <class Rows>
+    long long value(size_t id, Rows for_each_row) const
+    {
+        const State& s = states[id];
+        switch (s.spec.kind)
+        {
+        case AggregateKind::Sum:
+            return s.sum;
+        case AggregateKind::Mean:
+            return s.count ? s.sum / s.count : 0;
+        case AggregateKind::Min:
+        case AggregateKind::Max:
+            if (s.stale)
+            {
+                rescan(id, for_each_row);
+            }
+            return s.count ? s.extreme : 0;
+        default:
+            return s.count;
+        }
+    }
+
+    double mean(size_t id) const
+    {
+        const State& s = states[id];
+        return s.count ? (double)s.sum / (double)s.count : 0.0;
+    }
+
+    const std::vector<long long>& histogram(size_t id) const
+    {
+        return states[id].buckets;
+    }
+
+    // how many Min/Max reads had to rescan, for tuning and tests
+    size_t rescans() const
+    {
+        return rescan_count;
+    }
+
+private:
+    struct State
+    {
+        AggregateSpec spec;
+        long long sum = 0;
+        long long count = 0;
+        int extreme = 0;
+        long long extreme_count = 0;
+        bool stale = false;
+        std::vector<long long> buckets;
+    };
+
+    mutable std::vector<State> states;
+    mutable size_t rescan_count = 0;
+
+    static void reset_state(State& s)
+    {
+        s.sum = 0;
+        s.count = 0;
+        s.extreme = 0;
+        s.extreme_count = 0;
+        s.stale = false;
+        std::fill(s.buckets.begin(), s.buckets.end(), 0);
+    }
+
+    static void apply(State& s, int v, int delta)
+    {
+        if (v < s.spec.low || v > s.spec.high)
+        {
+            return;
+        }
+        s.sum += (long long)delta * v;
+        s.count += delta;
+        switch (s.spec.kind)
+        {
+        case AggregateKind::Min:
+        case AggregateKind::Max:
+            if (s.stale)
+            {
+                break;
+            }
+            if (delta > 0)
+            {
+                bool better = s.spec.kind == AggregateKind::Min ? v < s.extreme : v > s.extreme;
+                if (s.count == 1 || better)
+                {
+                    s.extreme = v;
+                    s.extreme_count = 1;
+                }
+                else if (v == s.extreme)
+                {
+                    s.extreme_count++;
+                }
+            }
+            else if (v == s.extreme && --s.extreme_count == 0 && s.count > 0)
+            {
+                s.stale = true;
+            }
+            break;
+        case AggregateKind::Histogram:
+        {
+            long long b = ((long long)v - s.spec.low) / s.spec.bucket_width;
+            b = b < 0 ? 0 : b >= (long long)s.buckets.size() ? (long long)s.buckets.size() - 1 : b;
+            s.buckets[(size_t)b] += delta;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    template <class Rows>
+    void rescan(size_t id, Rows for_each_row) const
+    {
+        State& s = states[id];
+        State fresh;
+        fresh.spec = s.spec;
+        for_each_row([&](int roll_no, const int* marks)
+        {
+            apply(fresh, student_field(s.spec.field, roll_no, marks), 1);
+        });
+        s.extreme = fresh.extreme;
+        s.extreme_count = fresh.extreme_count;
+        s.stale = false;
+        rescan_count++;
+    }
+};
+
+#endif
@@ -0,0 +1,536 @@
+// Batch mode for operator.cpp's calculator.
+//
+// operator.cpp applies the arithmetic, relational, logical and bitwise
+// operators to one pair n, m typed at a prompt. Here the same operators
+// run element-wise over two int32 columns, 8 (AVX2) or 4 (SSE4.1) lanes
+// at a time, picked at run time like markkernels.h. Arithmetic wraps as
+// two's complement instead of being undefined, shifts use the low 5 bits
+// of b, and division or modulo by zero yields 0 and marks the row invalid
+// rather than trapping; INT_MIN / -1 wraps to INT_MIN and its remainder
+// is 0. AVX2/SSE4.1 have no integer divide, so quotients are computed in
+// double, which is exact for 32-bit operands.
+//
+// Input is CSV lines  a,b  or a binary calc file; output is CSV (an
+// invalid result is an empty field) or a binary calc file, little-endian:
+//   CalcFileHeader   32 bytes
+//   int32[rows]      per column: a, b, then each operator's results
+//   uint8[rows]      if has_valid: 1 where the row divided by a nonzero b
+// A binary output can be read back as input; its first two columns are
+// a and b.
+#ifndef BATCHCALC_H
+#define BATCHCALC_H
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include "markkernels.h"
+#include "textinput.h"
+
+enum class CalcFamily
+{
+    Arithmetic,
+    Relational,
+    Logical,
+    Bitwise
+};
+
+enum class CalcOp : uint8_t
+{
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    Eq,
+    Gt,
+    Ge,
+    Lt,
+    Le,
+    Ne,
+    And,
+    Or,
+    Not,
+    BitAnd,
+    BitOr,
+    BitXor,
+    Shl,
+    Shr,
+    Compl
+};
+
+struct CalcOpInfo
+{
+    CalcOp op;
+    CalcFamily family;
+    const char* label;  // CSV column name, in operator.cpp's notation
+};
+
+// in operator.cpp's order; this is also the column order of the output
+static const CalcOpInfo calc_ops[] = {
+    {CalcOp::Add, CalcFamily::Arithmetic, "a+b"},
+    {CalcOp::Sub, CalcFamily::Arithmetic, "a-b"},
+    {CalcOp::Mul, CalcFamily::Arithmetic, "a*b"},
+    {CalcOp::Div, CalcFamily::Arithmetic, "a/b"},
+    {CalcOp::Mod, CalcFamily::Arithmetic, "a%b"},
+    {CalcOp::Eq, CalcFamily::Relational, "a==b"},
+    {CalcOp::Gt, CalcFamily::Relational, "a>b"},
+    {CalcOp::Ge, CalcFamily::Relational, "a>=b"},
+    {CalcOp::Lt, CalcFamily::Relational, "a<b"},
+    {CalcOp::Le, CalcFamily::Relational, "a<=b"},
+    {CalcOp::Ne, CalcFamily::Relational, "a!=b"},
+    {CalcOp::And, CalcFamily::Logical, "a&&b"},
+    {CalcOp::Or, CalcFamily::Logical, "a||b"},
+    {CalcOp::Not, CalcFamily::Logical, "!a"},
+    {CalcOp::BitAnd, CalcFamily::Bitwise, "a&b"},
+    {CalcOp::BitOr, CalcFamily::Bitwise, "a|b"},
+    {CalcOp::BitXor, CalcFamily::Bitwise, "a^b"},
+    {CalcOp::Shl, CalcFamily::Bitwise, "a<<b"},
+    {CalcOp::Shr, CalcFamily::Bitwise, "a>>b"},
+    {CalcOp::Compl, CalcFamily::Bitwise, "~a"},
+};
+
+// a set of families, one bit per CalcFamily
+typedef uint32_t CalcFamilies;
+
+inline CalcFamilies calc_family_bit(CalcFamily f)
+{
+    return 1u << (unsigned)f;
+}
+
+const CalcFamilies calc_all_families = 0xF;
+
+// "arithmetic", "relational", "logical", "bitwise" or "all"
+inline bool parse_calc_family(std::string_view name, CalcFamilies& out)
+{
+    static const char* const names[] = {"arithmetic", "relational", "logical", "bitwise"};
+    if (name == "all")
+    {
+        out = calc_all_families;
+        return true;
+    }
+    for (unsigned f = 0; f < 4; f++)
+    {
+        if (name == names[f])
+        {
+            out = 1u << f;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace calc_detail
+{
+
+template <CalcOp Op>
+inline int32_t scalar(int32_t a, int32_t b)
+{
+    const uint32_t ua = (uint32_t)a, ub = (uint32_t)b;
+    if constexpr (Op == CalcOp::Add) return (int32_t)(ua + ub);
+    if constexpr (Op == CalcOp::Sub) return (int32_t)(ua - ub);
+    if constexpr (Op == CalcOp::Mul) return (int32_t)(ua * ub);
+    if constexpr (Op == CalcOp::Div) return b == 0 ? 0 : b == -1 ? (int32_t)(0 - ua) : a / b;
+    if constexpr (Op == CalcOp::Mod) return b == 0 || b == -1 ? 0 : a % b;
+    if constexpr (Op == CalcOp::Eq) return a == b;
+    if constexpr (Op == CalcOp::Gt) return a > b;
+    if constexpr (Op == CalcOp::Ge) return a >= b;
+    if constexpr (Op == CalcOp::Lt) return a < b;
+    if constexpr (Op == CalcOp::Le) return a <= b;
+    if constexpr (Op == CalcOp::Ne) return a != b;
+    if constexpr (Op == CalcOp::And) return a && b;
+    if constexpr (Op == CalcOp::Or) return a || b;
+    if constexpr (Op == CalcOp::Not) return !a;
+    if constexpr (Op == CalcOp::BitAnd) return a & b;
+    if constexpr (Op == CalcOp::BitOr) return a | b;
+    if constexpr (Op == CalcOp::BitXor) return a ^ b;
+    if constexpr (Op == CalcOp::Shl) return (int32_t)(ua << (ub & 31));
+    if constexpr (Op == CalcOp::Shr) return a >> (ub & 31);
+    if constexpr (Op == CalcOp::Compl) return ~a;
+}
+
+#ifdef MARKKERNELS_X86
+// masks are all-ones lanes; the results of comparisons are 0 or 1
+template <CalcOp Op>
+__attribute__((target("avx2"))) inline size_t run_avx2(const int32_t* a, const int32_t* b, size_t n, int32_t* out)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i r;
+        if constexpr (Op == CalcOp::Add) r = _mm256_add_epi32(x, y);
+        if constexpr (Op == CalcOp::Sub) r = _mm256_sub_epi32(x, y);
+        if constexpr (Op == CalcOp::Mul) r = _mm256_mullo_epi32(x, y);
+        if constexpr (Op == CalcOp::Div || Op == CalcOp::Mod)
+        {
+            // divide by 1 where b is 0, then clear those lanes
+            __m256i by_zero = _mm256_cmpeq_epi32(y, zero);
+            __m256i d = _mm256_or_si256(y, _mm256_and_si256(by_zero, one));
+            __m128i q_lo = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(x)),
+                                                             _mm256_cvtepi32_pd(_mm256_castsi256_si128(d))));
+            __m128i q_hi = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1)),
+                                                             _mm256_cvtepi32_pd(_mm256_extracti128_si256(d, 1))));
+            // 2^31 (INT_MIN / -1) converts to INT_MIN, the wrapped quotient
+            __m256i q = _mm256_inserti128_si256(_mm256_castsi128_si256(q_lo), q_hi, 1);
+            if constexpr (Op == CalcOp::Mod) q = _mm256_sub_epi32(x, _mm256_mullo_epi32(q, d));
+            r = _mm256_andnot_si256(by_zero, q);
+        }
+        if constexpr (Op == CalcOp::Eq) r = _mm256_and_si256(_mm256_cmpeq_epi32(x, y), one);
+        if constexpr (Op == CalcOp::Gt) r = _mm256_and_si256(_mm256_cmpgt_epi32(x, y), one);
+        if constexpr (Op == CalcOp::Ge) r = _mm256_andnot_si256(_mm256_cmpgt_epi32(y, x), one);
+        if constexpr (Op == CalcOp::Lt) r = _mm256_and_si256(_mm256_cmpgt_epi32(y, x), one);
+        if constexpr (Op == CalcOp::Le) r = _mm256_andnot_si256(_mm256_cmpgt_epi32(x, y), one);
+        if constexpr (Op == CalcOp::Ne) r = _mm256_andnot_si256(_mm256_cmpeq_epi32(x, y), one);
+        if constexpr (Op == CalcOp::And) r = _mm256_andnot_si256(_mm256_or_si256(_mm256_cmpeq_epi32(x, zero), _mm256_cmpeq_epi32(y, zero)), one);
+        if constexpr (Op == CalcOp::Or) r = _mm256_andnot_si256(_mm256_and_si256(_mm256_cmpeq_epi32(x, zero), _mm256_cmpeq_epi32(y, zero)), one);
+        if constexpr (Op == CalcOp::Not) r = _mm256_and_si256(_mm256_cmpeq_epi32(x, zero), one);
+        if constexpr (Op == CalcOp::BitAnd) r = _mm256_and_si256(x, y);
+        if constexpr (Op == CalcOp::BitOr) r = _mm256_or_si256(x, y);
+        if constexpr (Op == CalcOp::BitXor) r = _mm256_xor_si256(x, y);
+        if constexpr (Op == CalcOp::Shl) r = _mm256_sllv_epi32(x, _mm256_and_si256(y, _mm256_set1_epi32(31)));
+        if constexpr (Op == CalcOp::Shr) r = _mm256_srav_epi32(x, _mm256_and_si256(y, _mm256_set1_epi32(31)));
+        if constexpr (Op == CalcOp::Compl) r = _mm256_xor_si256(x, _mm256_set1_epi32(-1));
+        _mm256_storeu_si256((__m256i*)(out + i), r);
+    }
+    return i;
+}
+
+// SSE has no per-lane variable shift, so Shl and Shr stay scalar
+template <CalcOp Op>
+__attribute__((target("sse4.1"))) inline size_t run_sse41(const int32_t* a, const int32_t* b, size_t n, int32_t* out)
+{
+    if constexpr (Op == CalcOp::Shl || Op == CalcOp::Shr)
+    {
+        (void)a, (void)b, (void)n, (void)out;
+        return 0;
+    }
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i r = zero;
+        if constexpr (Op == CalcOp::Add) r = _mm_add_epi32(x, y);
+        if constexpr (Op == CalcOp::Sub) r = _mm_sub_epi32(x, y);
+        if constexpr (Op == CalcOp::Mul) r = _mm_mullo_epi32(x, y);
+        if constexpr (Op == CalcOp::Div || Op == CalcOp::Mod)
+        {
+            __m128i by_zero = _mm_cmpeq_epi32(y, zero);
+            __m128i d = _mm_or_si128(y, _mm_and_si128(by_zero, one));
+            __m128i q_lo = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(x), _mm_cvtepi32_pd(d)));
+            __m128i q_hi = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(x, 0x4E)),
+                                                       _mm_cvtepi32_pd(_mm_shuffle_epi32(d, 0x4E))));
+            __m128i q = _mm_unpacklo_epi64(q_lo, q_hi);
+            if constexpr (Op == CalcOp::Mod) q = _mm_sub_epi32(x, _mm_mullo_epi32(q, d));
+            r = _mm_andnot_si128(by_zero, q);
+        }
+        if constexpr (Op == CalcOp::Eq) r = _mm_and_si128(_mm_cmpeq_epi32(x, y), one);
+        if constexpr (Op == CalcOp::Gt) r = _mm_and_si128(_mm_cmpgt_epi32(x, y), one);
+        if constexpr (Op == CalcOp::Ge) r = _mm_andnot_si128(_mm_cmplt_epi32(x, y), one);
+        if constexpr (Op == CalcOp::Lt) r = _mm_and_si128(_mm_cmplt_epi32(x, y), one);
+        if constexpr (Op == CalcOp::Le) r = _mm_andnot_si128(_mm_cmpgt_epi32(x, y), one);
+        if constexpr (Op == CalcOp::Ne) r = _mm_andnot_si128(_mm_cmpeq_epi32(x, y), one);
+        if constexpr (Op == CalcOp::And) r = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi32(x, zero), _mm_cmpeq_epi32(y, zero)), one);
+        if constexpr (Op == CalcOp::Or) r = _mm_andnot_si128(_mm_and_si128(_mm_cmpeq_epi32(x, zero), _mm_cmpeq_epi32(y, zero)), one);
+        if constexpr (Op == CalcOp::Not) r = _mm_and_si128(_mm_cmpeq_epi32(x, zero), one);
+        if constexpr (Op == CalcOp::BitAnd) r = _mm_and_si128(x, y);
+        if constexpr (Op == CalcOp::BitOr) r = _mm_or_si128(x, y);
+        if constexpr (Op == CalcOp::BitXor) r = _mm_xor_si128(x, y);
+        if constexpr (Op == CalcOp::Compl) r = _mm_xor_si128(x, _mm_set1_epi32(-1));
+        _mm_storeu_si128((__m128i*)(out + i), r);
+    }
+    return i;
+}
+#endif
+
+template <CalcOp Op>
+inline void run(const int32_t* a, const int32_t* b, size_t n, int32_t* out, SimdLevel level)
+{
+    size_t i = 0;
+#ifdef MARKKERNELS_X86
+    if (level == SimdLevel::AVX2)
+    {
+        i = run_avx2<Op>(a, b, n, out);
+    }
+    else if (level == SimdLevel::SSE41)
+    {
+        i = run_sse41<Op>(a, b, n, out);
+    }
+#endif
+    (void)level;
+    for (; i < n; i++)
+    {
+        out[i] = scalar<Op>(a[i], b[i]);
+    }
+}
+
+} // namespace calc_detail
+
+// out[i] = a[i] op b[i]; the unary operators (!, ~) ignore b
+inline void calc_apply(CalcOp op, const int32_t* a, const int32_t* b, size_t n, int32_t* out,
+                       SimdLevel level = detect_simd())
+{
+    using namespace calc_detail;
+    switch (op)
+    {
+    case CalcOp::Add: run<CalcOp::Add>(a, b, n, out, level); break;
+    case CalcOp::Sub: run<CalcOp::Sub>(a, b, n, out, level); break;
+    case CalcOp::Mul: run<CalcOp::Mul>(a, b, n, out, level); break;
+    case CalcOp::Div: run<CalcOp::Div>(a, b, n, out, level); break;
+    case CalcOp::Mod: run<CalcOp::Mod>(a, b, n, out, level); break;
+    case CalcOp::Eq: run<CalcOp::Eq>(a, b, n, out, level); break;
+    case CalcOp::Gt: run<CalcOp::Gt>(a, b, n, out, level); break;
+    case CalcOp::Ge: run<CalcOp::Ge>(a, b, n, out, level); break;
+    case CalcOp::Lt: run<CalcOp::Lt>(a, b, n, out, level); break;
+    case CalcOp::Le: run<CalcOp::Le>(a, b, n, out, level); break;
+    case CalcOp::Ne: run<CalcOp::Ne>(a, b, n, out, level); break;
+    case CalcOp::And: run<CalcOp::And>(a, b, n, out, level); break;
+    case CalcOp::Or: run<CalcOp::Or>(a, b, n, out, level); break;
+    case CalcOp::Not: run<CalcOp::Not>(a, b, n, out, level); break;
+    case CalcOp::BitAnd: run<CalcOp::BitAnd>(a, b, n, out, level); break;
+    case CalcOp::BitOr: run<CalcOp::BitOr>(a, b, n, out, level); break;
+    case CalcOp::BitXor: run<CalcOp::BitXor>(a, b, n, out, level); break;
+    case CalcOp::Shl: run<CalcOp::Shl>(a, b, n, out, level); break;
+    case CalcOp::Shr: run<CalcOp::Shr>(a, b, n, out, level); break;
+    case CalcOp::Compl: run<CalcOp::Compl>(a, b, n, out, level); break;
+    }
+}
+
+struct CalcTable
+{
+    CalcFamilies families = 0;
+    std::vector<int32_t> a, b;
+    std::vector<const CalcOpInfo*> ops;        // one per result column
+    std::vector<std::vector<int32_t>> results;
+    std::vector<uint8_t> valid;                // empty unless / or % ran
+    size_t invalid = 0;
+
+    size_t rows() const
+    {
+        return a.size();
+    }
+};
+
+// fills results (and valid) for every operator of the chosen families;
+// rows go through in blocks so a and b stay in cache across operators
+inline void calc_run(CalcTable& t, CalcFamilies families, SimdLevel level = detect_simd())
+{
+    const size_t block = 4096;
+    t.families = families;
+    t.ops.clear();
+    for (const CalcOpInfo& info : calc_ops)
+    {
+        if (families & calc_family_bit(info.family))
+        {
+            t.ops.push_back(&info);
+        }
+    }
+    t.results.resize(t.ops.size());
+    for (std::vector<int32_t>& column : t.results)
+    {
+        column.resize(t.rows());
+    }
+    for (size_t at = 0; at < t.rows(); at += block)
+    {
+        size_t len = std::min(block, t.rows() - at);
+        for (size_t c = 0; c < t.ops.size(); c++)
+        {
+            calc_apply(t.ops[c]->op, t.a.data() + at, t.b.data() + at, len, t.results[c].data() + at, level);
+        }
+    }
+    t.valid.clear();
+    t.invalid = 0;
+    if (families & calc_family_bit(CalcFamily::Arithmetic))
+    {
+        t.valid.resize(t.rows());
+        for (size_t i = 0; i < t.rows(); i++)
+        {
+            t.valid[i] = t.b[i] != 0;
+            t.invalid += t.b[i] == 0;
+        }
+    }
+}
+
+// n random pairs over the whole int32 range; about 1 in 16 b's are 0 so
+// the divide-by-zero path is exercised
+inline void calc_generate(CalcTable& t, size_t n, uint64_t seed = 1)
+{
+    std::mt19937_64 rng(seed);
+    t.a.resize(n);
+    t.b.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t r = rng();
+        t.a[i] = (int32_t)(uint32_t)r;
+        t.b[i] = (r >> 60) == 0 ? 0 : (int32_t)(uint32_t)(r >> 32);
+    }
+}
+
+static const char calc_magic[8] = {'O', 'P', 'C', 'A', 'L', 'C', '0', '1'};
+
+struct CalcFileHeader
+{
+    char magic[8];
+    uint32_t families;   // CalcFamilies whose results follow a and b
+    uint32_t columns;    // int32 columns, a and b included
+    uint64_t rows;
+    uint32_t has_valid;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(CalcFileHeader) == 32, "calc file header must stay 32 bytes");
+
+// takes a and b from CSV lines "a,b" or from a binary calc file; other
+// columns of a binary file are ignored
+inline bool calc_parse_input(std::string_view data, CalcTable& t, std::string& error)
+{
+    t.a.clear();
+    t.b.clear();
+    if (data.size() >= sizeof(CalcFileHeader) && std::memcmp(data.data(), calc_magic, 8) == 0)
+    {
+        CalcFileHeader h;
+        std::memcpy(&h, data.data(), sizeof(h));
+        if (h.columns < 2 || h.rows > (data.size() - sizeof(h)) / 4 / h.columns)
+        {
+            error = "truncated or corrupt calc file";
+            return false;
+        }
+        const char* column = data.data() + sizeof(h);
+        t.a.resize(h.rows);
+        t.b.resize(h.rows);
+        std::memcpy(t.a.data(), column, h.rows * 4);
+        std::memcpy(t.b.data(), column + h.rows * 4, h.rows * 4);
+        return true;
+    }
+    size_t line_no = 0;
+    while (!data.empty())
+    {
+        size_t end = data.find('\n');
+        std::string_view line = data.substr(0, end);
+        data = end == std::string_view::npos ? std::string_view() : data.substr(end + 1);
+        line_no++;
+        std::string_view trimmed = batch_detail::trim(line);
+        if (trimmed.empty() || trimmed.front() == '#')
+        {
+            continue;
+        }
+        size_t comma = trimmed.find(',');
+        int a, b;
+        if (comma == std::string_view::npos || !batch_detail::parse_int(trimmed.substr(0, comma), a) ||
+            !batch_detail::parse_int(trimmed.substr(comma + 1), b))
+        {
+            if (line_no == 1)
+            {
+                continue;  // header
+            }
+            error = "line " + std::to_string(line_no) + ": expected a,b";
+            return false;
+        }
+        t.a.push_back(a);
+        t.b.push_back(b);
+    }
+    return true;
+}
+
+namespace calc_detail
+{
+
+inline bool write_all(int fd, const char* p, size_t n)
+{
+    while (n > 0)
+    {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (w < 0)
+        {
+            return false;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+} // namespace calc_detail
+
+inline bool calc_write_binary(int fd, const CalcTable& t)
+{
+    using calc_detail::write_all;
+    CalcFileHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, calc_magic, 8);
+    h.families = t.families;
+    h.columns = (uint32_t)(2 + t.results.size());
+    h.rows = t.rows();
+    h.has_valid = !t.valid.empty();
+    bool ok = write_all(fd, (const char*)&h, sizeof(h)) && write_all(fd, (const char*)t.a.data(), t.rows() * 4) &&
+              write_all(fd, (const char*)t.b.data(), t.rows() * 4);
+    for (size_t c = 0; ok && c < t.results.size(); c++)
+    {
+        ok = write_all(fd, (const char*)t.results[c].data(), t.rows() * 4);
+    }
+    return ok && write_all(fd, (const char*)t.valid.data(), t.valid.size());
+}
+
+inline bool calc_write_csv(int fd, const CalcTable& t)
+{
+    std::string buffer = "a,b";
+    for (const CalcOpInfo* info : t.ops)
+    {
+        buffer += ',';
+        buffer += info->label;
+    }
+    buffer += '\n';
+    char digits[16];
+    auto number = [&](int32_t v)
+    {
+        std::to_chars_result r = std::to_chars(digits, digits + sizeof(digits), v);
+        buffer.append(digits, (size_t)(r.ptr - digits));
+    };
+    for (size_t i = 0; i < t.rows(); i++)
+    {
+        number(t.a[i]);
+        buffer += ',';
+        number(t.b[i]);
+        for (size_t c = 0; c < t.results.size(); c++)
+        {
+            buffer += ',';
+            CalcOp op = t.ops[c]->op;
+            if ((op != CalcOp::Div && op != CalcOp::Mod) || t.b[i] != 0)
+            {
+                number(t.results[c][i]);
+            }
+        }
+        buffer += '\n';
+        if (buffer.size() >= 64 * 1024)
+        {
+            if (!calc_detail::write_all(fd, buffer.data(), buffer.size()))
+            {
+                return false;
+            }
+            buffer.clear();
+        }
+    }
+    return calc_detail::write_all(fd, buffer.data(), buffer.size());
+}
+
+#endif
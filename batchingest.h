@@ -0,0 +1,154 @@
+// Non-interactive bulk load for studentrecord --batch.
+//
+// The whole input is read into one buffer and parsed in place: fields are
+// string_views into the buffer and numbers go through std::from_chars, so
+// there are no iostream extractions, prompts or flushes per field.
+//
+// Each line is  name,roll_no,mark1,mark2,mark3,mark4  separated by commas,
+// or by tabs if the first line contains one. A CSV name may be quoted
+// ("Smith, Al" or "say ""hi"""). Blank lines and lines starting with '#'
+// are skipped, and a first line whose roll_no is not a number is taken as
+// a header. Bad lines are reported and skipped; they never stop the load.
+#ifndef BATCHINGEST_H
+#define BATCHINGEST_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "studentregistry.h"
+#include "textinput.h"
+
+struct IngestError
+{
+    size_t line;
+    std::string message;
+};
+
+struct IngestResult
+{
+    size_t lines = 0;
+    size_t added = 0;
+    size_t duplicates = 0;
+    size_t bad = 0;
+    std::vector<IngestError> errors;  // the first max_errors problems
+};
+
+inline IngestResult ingest_records(std::string_view data, StudentRegistry& registry,
+                                   size_t max_errors = 100)
+{
+    using namespace batch_detail;
+
+    IngestResult result;
+    size_t first_end = data.find('\n');
+    std::string_view first_line = data.substr(0, first_end);
+    char delim = first_line.find('\t') != std::string_view::npos ? '\t' : ',';
+
+    auto report = [&](size_t line, std::string message)
+    {
+        result.bad++;
+        if (result.errors.size() < max_errors)
+        {
+            result.errors.push_back(IngestError{line, std::move(message)});
+        }
+    };
+
+    // one reservation up front instead of repeated growth and rehashing
+    size_t newlines = 0;
+    const char* end_of_data = data.data() + data.size();
+    const char* nl = data.data();
+    while ((nl = (const char*)std::memchr(nl, '\n', end_of_data - nl)) != nullptr)
+    {
+        newlines++;
+        nl++;
+    }
+    registry.reserve(registry.size() + newlines + 1);
+    registry.defer_indexes();
+
+    std::string scratch;
+    std::string_view fields[6];
+    size_t pos = 0;
+    size_t line_no = 0;
+    while (pos < data.size())
+    {
+        size_t end = data.find('\n', pos);
+        if (end == std::string_view::npos)
+        {
+            end = data.size();
+        }
+        std::string_view line = data.substr(pos, end - pos);
+        pos = end + 1;
+        line_no++;
+
+        std::string_view content = trim(line);
+        if (content.empty() || content.front() == '#')
+        {
+            continue;
+        }
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+        result.lines++;
+
+        bool bad_quote;
+        size_t n = split(line, delim, fields, 6, scratch, bad_quote);
+        if (bad_quote)
+        {
+            report(line_no, "unterminated quoted name");
+            continue;
+        }
+        int roll_no;
+        if (n >= 2 && !parse_int(fields[1], roll_no))
+        {
+            if (result.lines == 1)
+            {
+                result.lines--;  // header row
+                continue;
+            }
+            report(line_no, "roll_no is not a number");
+            continue;
+        }
+        if (n != 6)
+        {
+            report(line_no, n > 6 ? "more than 6 fields"
+                                  : "expected 6 fields, found " + std::to_string(n));
+            continue;
+        }
+        int marks[4];
+        bool ok = true;
+        for (int k = 0; k < 4 && ok; k++)
+        {
+            if (!parse_int(fields[2 + k], marks[k]))
+            {
+                report(line_no, "mark " + std::to_string(k + 1) + " is not a number");
+                ok = false;
+            }
+        }
+        if (!ok)
+        {
+            continue;
+        }
+        if (registry.add(trim(fields[0]), roll_no, marks))
+        {
+            result.added++;
+        }
+        else if (!registry.contains(roll_no))
+        {
+            report(line_no, "no room for the name (names are limited to 4 GB in all)");
+        }
+        else
+        {
+            result.duplicates++;
+            if (result.errors.size() < max_errors)
+            {
+                result.errors.push_back(
+                    IngestError{line_no, "duplicate roll_no " + std::to_string(roll_no)});
+            }
+        }
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,160 @@
+// Materialized aggregates: the cost they add to each add/update/delete,
+// and reading them against recomputing the same figures with a scan.
+// A random mix of changes runs with and without six aggregates defined;
+// afterwards every maintained value is compared with a fresh definition
+// computed from scratch. Deleting the current maximum shows the lazy
+// Max rescan.
+//   usage: aggregates_bench [students] [changes]   (default 1000000 1000000)
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static vector<AggregateSpec> make_specs()
+{
+    vector<AggregateSpec> specs(6);
+    specs[0].kind = AggregateKind::Mean;
+    specs[0].field = StudentField::Mark3;
+    specs[1].kind = AggregateKind::Count;
+    specs[1].field = StudentField::Total;
+    specs[1].low = 301;
+    specs[2].kind = AggregateKind::Min;
+    specs[2].field = StudentField::Total;
+    specs[3].kind = AggregateKind::Max;
+    specs[3].field = StudentField::Total;
+    specs[4].kind = AggregateKind::Histogram;
+    specs[4].field = StudentField::Total;
+    specs[4].low = 0;
+    specs[4].bucket_width = 40;
+    specs[4].buckets = 10;
+    specs[5].kind = AggregateKind::Sum;
+    specs[5].field = StudentField::Mark1;
+    return specs;
+}
+
+static void load(StudentRegistry& registry, size_t n)
+{
+    registry.reserve(n);
+    registry.defer_indexes();
+    for (size_t i = 0; i < n; i++)
+    {
+        registry.add(make_student((int)i + 1, i));
+    }
+}
+
+// the same change sequence for both runs
+static double churn(StudentRegistry& registry, size_t n, size_t changes)
+{
+    mt19937_64 rng(9);
+    int next_roll = (int)n + 1;
+    Timer t;
+    for (size_t c = 0; c < changes; c++)
+    {
+        uint64_t r = rng();
+        int roll = (int)(r % (uint64_t)next_roll) + 1;
+        switch ((r >> 40) & 3)
+        {
+        case 0:
+            registry.remove(roll);
+            break;
+        case 1:
+            registry.add(make_student(next_roll, r));
+            next_roll++;
+            break;
+        default:
+            registry.update(make_student(roll, r >> 8));
+            break;
+        }
+    }
+    return t.seconds();
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t changes = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1000000;
+    vector<AggregateSpec> specs = make_specs();
+    bool ok = true;
+
+    StudentRegistry plain, maintained;
+    load(plain, n);
+    load(maintained, n);
+    vector<size_t> ids;
+    for (const AggregateSpec& spec : specs)
+    {
+        ids.push_back(maintained.define_aggregate(spec));
+    }
+
+    printf("students=%zu changes=%zu\n%-36s %12s\n", n, changes, "add/update/delete mix", "ns/change");
+    double base = churn(plain, n, changes);
+    double with = churn(maintained, n, changes);
+    printf("%-36s %12.1f\n", "no aggregates", base / changes * 1e9);
+    printf("%-36s %12.1f\n", "6 aggregates", with / changes * 1e9);
+
+    printf("\n%-36s %12s\n", "read all 6", "us");
+    {
+        size_t before = 0;
+        Timer first;
+        for (size_t id : ids)
+        {
+            before += maintained.aggregate(id) != 0;
+        }
+        do_not_optimize(before);
+        printf("%-36s %12.3f\n", "first read (stale Min/Max rescan)", first.seconds() * 1e6);
+        Timer t;
+        long long v = 0;
+        for (int r = 0; r < 1000; r++)
+        {
+            for (size_t id : ids)
+            {
+                v += maintained.aggregate(id);
+            }
+        }
+        do_not_optimize(v);
+        printf("%-36s %12.3f\n", "maintained", t.seconds() * 1e6 / 1000);
+    }
+    vector<size_t> fresh;
+    {
+        Timer t;
+        for (const AggregateSpec& spec : specs)
+        {
+            fresh.push_back(maintained.define_aggregate(spec));
+        }
+        printf("%-36s %12.3f\n", "recomputed by a scan", t.seconds() * 1e6);
+    }
+    for (size_t k = 0; k < specs.size(); k++)
+    {
+        ok = ok && maintained.aggregate(ids[k]) == maintained.aggregate(fresh[k]) &&
+             maintained.aggregate_count(ids[k]) == maintained.aggregate_count(fresh[k]) &&
+             maintained.aggregate_histogram(ids[k]) == maintained.aggregate_histogram(fresh[k]);
+    }
+
+    // delete every student holding the top total: the Max goes stale once
+    int top = (int)maintained.aggregate(ids[3]);
+    vector<int> holders;
+    maintained.for_each_row([&](int roll_no, const int* marks, string_view)
+    {
+        if (marks[0] + marks[1] + marks[2] + marks[3] == top)
+        {
+            holders.push_back(roll_no);
+        }
+    });
+    for (int roll : holders)
+    {
+        maintained.remove(roll);
+    }
+    Timer t;
+    int new_top = (int)maintained.aggregate(ids[3]);
+    printf("\ndeleted the %zu students with total %d; next Max read %.3f ms, now %d\n", holders.size(), top,
+           t.seconds() * 1e3, new_top);
+    size_t check = maintained.define_aggregate(specs[3]);
+    ok = ok && new_top < top && new_top == maintained.aggregate(check);
+
+    printf("%s\n", ok ? "results match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+// Small helpers shared by the benchmark programs in this directory.
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../student.h"
+
+class Timer
+{
+public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+
+    double seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// keeps the optimizer from discarding a computed value
+template <class T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// n distinct roll numbers in random order
+inline std::vector<int> make_rolls(size_t n, uint64_t seed = 42)
+{
+    std::vector<int> rolls(n);
+    std::iota(rolls.begin(), rolls.end(), 1);
+    std::mt19937_64 rng(seed);
+    std::shuffle(rolls.begin(), rolls.end(), rng);
+    return rolls;
+}
+
+inline Student make_student(int roll_no, uint64_t seed)
+{
+    int marks[4];
+    for (int k = 0; k < 4; k++)
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        marks[k] = (int)((seed >> 33) % 101);
+    }
+    return Student("S" + std::to_string(roll_no), roll_no, marks);
+}
+
+// record counts from argv, or the given defaults
+inline std::vector<size_t> sizes_from_args(int argc, char** argv, std::vector<size_t> defaults)
+{
+    if (argc < 2)
+    {
+        return defaults;
+    }
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++)
+    {
+        sizes.push_back((size_t)std::strtoull(argv[i], nullptr, 10));
+    }
+    return sizes;
+}
+
+#endif
@@ -0,0 +1,161 @@
+// BigInt arithmetic: multiplication at a range of sizes for several
+// Karatsuba cutoffs (SIZE_MAX is schoolbook only), used to pick
+// BigInt::karatsuba_cutoff; computing F(k) by fast doubling with each
+// multiply; and printing F(k) in decimal by dividing out 19 digits at a
+// time against the divide-and-conquer to_string. Results are checked
+// against each other, and every power of ten up to 10^5000 is printed and
+// parsed back.
+//   usage: bigint_bench [k]   (default 1000000)
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "../bigint.h"
+#include "../fibonacci.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static BigInt random_bigint(size_t limbs, mt19937_64& rng)
+{
+    BigInt r;
+    BigInt base = BigInt(1ull << 32) * BigInt(1ull << 32);
+    for (size_t i = 0; i < limbs; i++)
+    {
+        r = r * base + BigInt(rng() | 1);
+    }
+    return r;
+}
+
+// the straightforward conversion: repeatedly divide by 10^19
+static string chunked_decimal(const BigInt& x)
+{
+    BigInt::Limbs m = x.magnitude();
+    vector<uint64_t> chunks;
+    while (!m.empty())
+    {
+        unsigned __int128 rem = 0;
+        for (size_t i = m.size(); i-- > 0;)
+        {
+            rem = (rem << 64) | m[i];
+            m[i] = (uint64_t)(rem / 10000000000000000000ull);
+            rem %= 10000000000000000000ull;
+        }
+        while (!m.empty() && m.back() == 0)
+        {
+            m.pop_back();
+        }
+        chunks.push_back((uint64_t)rem);
+    }
+    if (chunks.empty())
+    {
+        return "0";
+    }
+    string s = to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;)
+    {
+        string part = to_string(chunks[i]);
+        s.append(19 - part.size(), '0');
+        s += part;
+    }
+    return s;
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t k = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    const size_t cutoffs[] = {SIZE_MAX, 16, 32, 48, 64, 96};
+    const size_t default_cutoff = BigInt::karatsuba_cutoff;
+    mt19937_64 rng(5);
+    bool ok = true;
+
+    printf("multiply, us per product (cutoff %zu is the default)\n%8s", default_cutoff, "limbs");
+    for (size_t c : cutoffs)
+    {
+        if (c == SIZE_MAX)
+        {
+            printf(" %10s", "schoolbook");
+        }
+        else
+        {
+            printf(" %10zu", c);
+        }
+    }
+    printf("\n");
+    for (size_t limbs = 16; limbs <= 8192; limbs *= 2)
+    {
+        BigInt a = random_bigint(limbs, rng), b = random_bigint(limbs, rng);
+        BigInt expect;
+        printf("%8zu", limbs);
+        for (size_t c : cutoffs)
+        {
+            BigInt::karatsuba_cutoff = c;
+            int reps = (int)(2000000 / (limbs * limbs)) + 1;
+            BigInt p;
+            Timer t;
+            for (int r = 0; r < reps; r++)
+            {
+                p = a * b;
+            }
+            printf(" %10.1f", t.seconds() * 1e6 / reps);
+            if (c == SIZE_MAX)
+            {
+                expect = p;
+            }
+            ok = ok && p == expect;
+        }
+        printf("\n");
+    }
+
+    printf("\n%-36s %12s\n", ("F(" + to_string(k) + ")").c_str(), "ms");
+    BigInt f;
+    for (size_t c : {SIZE_MAX, default_cutoff})
+    {
+        BigInt::karatsuba_cutoff = c;
+        Timer t;
+        BigInt g = fibonacci(k);
+        double ms = t.seconds() * 1e3;
+        printf("%-36s %12.1f\n", c == SIZE_MAX ? "fast doubling, schoolbook" : "fast doubling, Karatsuba", ms);
+        ok = ok && g.low64() == fib_mod64(k);
+        if (c != SIZE_MAX)
+        {
+            ok = ok && g == f;
+        }
+        f = g;
+    }
+
+    printf("\n%-36s %12s\n", ("print F(" + to_string(k) + ")").c_str(), "ms");
+    string chunked, split;
+    {
+        Timer t;
+        chunked = chunked_decimal(f);
+        printf("%-36s %12.1f\n", "divide by 10^19 per chunk", t.seconds() * 1e3);
+    }
+    {
+        Timer t;
+        split = f.to_string();
+        printf("%-36s %12.1f   %zu digits\n", "divide and conquer", t.seconds() * 1e3, split.size());
+    }
+    ok = ok && split == chunked;
+
+    // powers of ten split into halves whose low half is all zeros
+    {
+        Timer t;
+        BigInt power(1), ten(10), back;
+        bool powers_ok = true;
+        for (size_t e = 0; e <= 5000; e++)
+        {
+            string s = power.to_string();
+            powers_ok = powers_ok && s.size() == e + 1 && s[0] == '1' &&
+                        s.find_first_not_of('0', 1) == string::npos && BigInt::parse(s, back) && back == power;
+            power = power * ten;
+        }
+        printf("%-36s %12.1f\n", "10^0 .. 10^5000 round trip", t.seconds() * 1e3);
+        ok = ok && powers_ok;
+    }
+
+    printf("%s\n", ok ? "results match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
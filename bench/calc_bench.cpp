@@ -0,0 +1,86 @@
+// operator.cpp's operators applied element-wise to two int32 columns,
+// per family, with the scalar loop against the SSE4.1 and AVX2 kernels
+// in batchcalc.h, then the cost of writing the results as CSV or binary
+// (to a file in /tmp). Rates are operator applications per second; results
+// are checked against the scalar loop.
+//   usage: calc_bench [rows]   (default 10000000)
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+
+#include "../batchcalc.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static const int reps = 3;
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+    CalcTable input;
+    calc_generate(input, n);
+    bool ok = true;
+
+    static const char* const family_names[] = {"arithmetic", "relational", "logical", "bitwise"};
+    printf("rows=%zu  best=%s\n%-12s", n, simd_name(detect_simd()), "family");
+    const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2};
+    for (SimdLevel level : levels)
+    {
+        printf(" %14s", (string(simd_name(level)) + " Mops/s").c_str());
+    }
+    printf(" %9s\n", "speedup");
+
+    CalcTable expect = input, table = input;
+    for (unsigned f = 0; f < 4; f++)
+    {
+        CalcFamilies family = 1u << f;
+        double rate[3] = {0, 0, 0};
+        printf("%-12s", family_names[f]);
+        for (int l = 0; l < 3; l++)
+        {
+            if (levels[l] > detect_simd())
+            {
+                printf(" %14s", "-");
+                continue;
+            }
+            CalcTable& t = l == 0 ? expect : table;
+            double best = 1e9;
+            for (int r = 0; r < reps; r++)
+            {
+                Timer timer;
+                calc_run(t, family, levels[l]);
+                best = min(best, timer.seconds());
+            }
+            rate[l] = (double)n * t.ops.size() / best / 1e6;
+            printf(" %14.0f", rate[l]);
+            ok = ok && t.results == expect.results && t.valid == expect.valid;
+        }
+        double fastest = max(rate[1], rate[2]);
+        printf(" %8.1fx\n", fastest / rate[0]);
+    }
+
+    printf("\n%-12s %14s %14s %14s\n", "output", "ms", "MB", "MB/s");
+    calc_run(table, calc_all_families);
+    for (int binary = 0; binary < 2; binary++)
+    {
+        char path[] = "/tmp/calc_benchXXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0)
+        {
+            perror("mkstemp");
+            return 1;
+        }
+        Timer timer;
+        ok = (binary ? calc_write_binary(fd, table) : calc_write_csv(fd, table)) && ok;
+        double s = timer.seconds();
+        double mb = (double)lseek(fd, 0, SEEK_END) / 1e6;
+        ::close(fd);
+        unlink(path);
+        printf("%-12s %14.1f %14.1f %14.0f\n", binary ? "binary" : "csv", s * 1e3, mb, mb / s);
+    }
+
+    printf("%s\n", ok ? "results match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
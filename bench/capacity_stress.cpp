@@ -0,0 +1,99 @@
+// Stress test for the heap-backed registry storage. Loads far more
+// records than an 8 MB stack could ever hold (the old `Student s[num]`
+// VLA overflowed it at roughly 150k students), checks every record is
+// reachable, and counts heap allocations to show that a reserved bulk
+// load allocates once while an unreserved one grows geometrically.
+//   usage: capacity_stress [records]   (default 2000000)
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static size_t allocations = 0;
+
+// noinline, or -Wmismatched-new-delete fires once these are inlined
+// next to a new-expression
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    allocations++;
+    if (void* p = malloc(size))
+    {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+static bool check_all(const StudentRegistry& registry, size_t n)
+{
+    Student st;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!registry.get((int)i + 1, st) || st.get_roll_no() != (int)i + 1)
+        {
+            printf("  record %zu missing\n", i + 1);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+    double mb = (double)n * sizeof(Student) / (1024 * 1024);
+    printf("records=%zu  record bytes=%zu  payload=%.1f MB (stack limit is 8 MB)\n",
+           n, sizeof(Student), mb);
+
+    bool ok = true;
+    {
+        StudentRegistry registry;
+        size_t before = allocations;
+        Timer t;
+        for (size_t i = 0; i < n; i++)
+        {
+            registry.add(make_student((int)i + 1, i));
+        }
+        printf("  unreserved load: %.3f s, %zu allocations\n", t.seconds(), allocations - before);
+        ok = ok && check_all(registry, n);
+    }
+    {
+        StudentRegistry registry;
+        size_t before = allocations;
+        registry.reserve(n);
+        size_t reserve_allocs = allocations - before;
+        Timer t;
+        for (size_t i = 0; i < n; i++)
+        {
+            registry.add(make_student((int)i + 1, i));
+        }
+        printf("  reserved load:   %.3f s, %zu allocations in reserve, %zu during load\n",
+               t.seconds(), reserve_allocs, allocations - before - reserve_allocs);
+        ok = ok && check_all(registry, n);
+
+        for (size_t i = 0; i < n; i += 2)
+        {
+            registry.remove((int)i + 1);
+        }
+        size_t cap = registry.capacity();
+        registry.shrink_to_fit();
+        printf("  after deleting half: capacity %zu -> %zu\n", cap, registry.capacity());
+        ok = ok && registry.size() == n - (n + 1) / 2;
+    }
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+// Throughput of ShardedRegistry with 1..N threads at 90/10 and 50/50
+// read/write mixes, against a StudentRegistry behind one mutex. Reads are
+// get() on a random roll; writes alternate between update() and a
+// remove() + add() of the same roll, so the key set stays the same size.
+//   usage: concurrent_bench [records] [ops per thread] [max threads]
+//          (default 1000000 2000000 hardware_concurrency)
+// Build with -pthread; add -fsanitize=thread to check it under TSan.
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../shardedregistry.h"
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+// the single-lock baseline
+class LockedRegistry
+{
+public:
+    bool get(int roll_no, Student& out)
+    {
+        lock_guard<mutex> lock(m);
+        return registry.get(roll_no, out);
+    }
+
+    bool add(const Student& st)
+    {
+        lock_guard<mutex> lock(m);
+        return registry.add(st);
+    }
+
+    bool update(const Student& st)
+    {
+        lock_guard<mutex> lock(m);
+        return registry.update(st);
+    }
+
+    bool remove(int roll_no)
+    {
+        lock_guard<mutex> lock(m);
+        return registry.remove(roll_no);
+    }
+
+private:
+    mutex m;
+    StudentRegistry registry{DeleteMode::SwapRemove};
+};
+
+template <class R>
+static void worker(R& registry, size_t n, size_t ops, int write_pct, uint64_t seed, long long& hits)
+{
+    Student st;
+    long long found = 0;
+    for (size_t i = 0; i < ops; i++)
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        int roll_no = (int)((seed >> 33) % n) + 1;
+        if ((int)((seed >> 20) % 100) >= write_pct)
+        {
+            found += registry.get(roll_no, st);
+        }
+        else if (seed & (1 << 10))
+        {
+            registry.update(make_student(roll_no, seed));
+        }
+        else if (registry.remove(roll_no))
+        {
+            registry.add(make_student(roll_no, seed));
+        }
+    }
+    hits = found;
+}
+
+template <class R>
+static double run(R& registry, size_t n, size_t ops, int write_pct, unsigned threads)
+{
+    vector<thread> pool;
+    vector<long long> hits(threads);
+    Timer t;
+    for (unsigned k = 0; k < threads; k++)
+    {
+        pool.emplace_back([&, k] { worker(registry, n, ops, write_pct, 1000 + k, hits[k]); });
+    }
+    for (thread& th : pool)
+    {
+        th.join();
+    }
+    double s = t.seconds();
+    long long total = 0;
+    for (long long h : hits)
+    {
+        total += h;
+    }
+    do_not_optimize(total);
+    return threads * ops / s / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t ops = argc > 2 ? strtoull(argv[2], nullptr, 10) : 2000000;
+    unsigned max_threads = argc > 3 ? (unsigned)atoi(argv[3]) : thread::hardware_concurrency();
+    if (max_threads == 0)
+    {
+        max_threads = 1;
+    }
+
+    ShardedRegistry sharded;
+    LockedRegistry locked;
+    for (size_t i = 0; i < n; i++)
+    {
+        Student st = make_student((int)i + 1, i);
+        sharded.add(st);
+        locked.add(st);
+    }
+
+    printf("%zu records, %zu ops per thread\n", n, ops);
+    printf("%8s %8s %16s %16s\n", "mix", "threads", "sharded Mops/s", "locked Mops/s");
+    for (int write_pct : {10, 50})
+    {
+        for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+        {
+            double sharded_mops = run(sharded, n, ops, write_pct, threads);
+            double locked_mops = run(locked, n, ops, write_pct, threads);
+            printf("%5d/%-2d %8u %16.2f %16.2f\n", 100 - write_pct, write_pct, threads,
+                   sharded_mops, locked_mops);
+        }
+    }
+    if (sharded.size() != n)
+    {
+        printf("FAIL: %zu records after the run, expected %zu\n", sharded.size(), n);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Bulk-deletes 10% of the registry in random order and reports the cost
+// per delete for both delete modes. Per-delete time that stays flat as the
+// registry grows means the bulk delete is linear overall. The old
+// shift-down loop from case 5 is run at the smaller sizes for contrast.
+//   usage: delete_bench [records...]   (default 10000 100000 1000000)
+#include <cstdio>
+#include <vector>
+
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static double registry_delete(size_t n, DeleteMode mode, const vector<int>& victims)
+{
+    StudentRegistry registry(mode);
+    for (size_t i = 0; i < n; i++)
+    {
+        registry.add(make_student((int)i + 1, i));
+    }
+    Timer t;
+    for (int roll_no : victims)
+    {
+        registry.remove(roll_no);
+    }
+    return t.seconds();
+}
+
+static double shift_delete(size_t n, const vector<int>& victims)
+{
+    vector<Student> s;
+    for (size_t i = 0; i < n; i++)
+    {
+        s.push_back(make_student((int)i + 1, i));
+    }
+    int num = (int)n;
+    Timer t;
+    for (int roll_no : victims)
+    {
+        for (int i = 0; i < num; i++)
+        {
+            if (s[i].get_roll_no() == roll_no)
+            {
+                s[i].delete_data();
+                for (int j = i; j < num - 1; j++)
+                {
+                    s[j] = s[j + 1];
+                }
+                num--;
+                break;
+            }
+        }
+    }
+    return t.seconds();
+}
+
+int main(int argc, char** argv)
+{
+    printf("%10s %10s %14s %14s %14s\n", "records", "deletes", "swap ns/op", "stable ns/op", "shift ns/op");
+    for (size_t n : sizes_from_args(argc, argv, {10000, 100000, 1000000}))
+    {
+        vector<int> victims = make_rolls(n, 11);
+        victims.resize(n / 10);
+
+        double swap_s = registry_delete(n, DeleteMode::SwapRemove, victims);
+        double stable_s = registry_delete(n, DeleteMode::Stable, victims);
+        printf("%10zu %10zu %14.1f %14.1f", n, victims.size(),
+               swap_s / victims.size() * 1e9, stable_s / victims.size() * 1e9);
+        if (n <= 100000)
+        {
+            double shift_s = shift_delete(n, victims);
+            printf(" %14.1f\n", shift_s / victims.size() * 1e9);
+        }
+        else
+        {
+            printf(" %14s\n", "(skipped)");
+        }
+    }
+    return 0;
+}
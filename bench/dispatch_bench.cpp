@@ -0,0 +1,135 @@
+// Command dispatch through a compile-time CommandTable against an
+// unordered_map<string, function> built at run time, by name (as a
+// script or replay log would) and by menu number (against a switch).
+// Commands are drawn at random from eleven names, like the menu's.
+//   usage: dispatch_bench [dispatches]   (default 100000000)
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../commands.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static long long counts[12];
+
+template <int I>
+static void handler(long long& sink)
+{
+    counts[I]++;
+    sink += I;
+}
+
+typedef void (*Handler)(long long&);
+
+static constexpr auto table = make_command_table<Handler>({
+    {1, "add", "", handler<1>},
+    {2, "list", "", handler<2>},
+    {3, "show", "", handler<3>},
+    {4, "update", "", handler<4>},
+    {5, "delete", "", handler<5>},
+    {6, "exit", "", handler<6>},
+    {7, "stats", "", handler<7>},
+    {8, "save", "", handler<8>},
+    {9, "search", "", handler<9>},
+    {10, "top", "", handler<10>},
+    {11, "rank", "", handler<11>},
+});
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000000;
+
+    // a fixed stream of commands, reused round-robin
+    const size_t stream = 1 << 16;
+    vector<string> names(stream);
+    vector<string_view> views(stream);
+    vector<int> codes(stream);
+    mt19937_64 rng(3);
+    for (size_t i = 0; i < stream; i++)
+    {
+        int k = (int)(rng() % table.size());
+        names[i] = string(table[k].name);
+        codes[i] = table[k].code;
+    }
+    for (size_t i = 0; i < stream; i++)
+    {
+        views[i] = names[i];
+    }
+
+    unordered_map<string, function<void(long long&)>> map;
+    for (size_t k = 0; k < table.size(); k++)
+    {
+        map.emplace(string(table[k].name), table[k].handler);
+    }
+
+    long long sink = 0;
+    printf("dispatches=%zu\n%-36s %10s %10s\n", n, "by name", "ns/op", "Mops/s");
+    {
+        Timer t;
+        for (size_t i = 0; i < n; i++)
+        {
+            table[table.find(views[i & (stream - 1)])].handler(sink);
+        }
+        double s = t.seconds();
+        printf("%-36s %10.2f %10.1f\n", "CommandTable (perfect hash)", s / n * 1e9, n / s / 1e6);
+    }
+    {
+        Timer t;
+        for (size_t i = 0; i < n; i++)
+        {
+            map.find(names[i & (stream - 1)])->second(sink);
+        }
+        double s = t.seconds();
+        printf("%-36s %10.2f %10.1f\n", "unordered_map<string, function>", s / n * 1e9, n / s / 1e6);
+    }
+
+    printf("%-36s %10s %10s\n", "by number", "ns/op", "Mops/s");
+    {
+        Timer t;
+        for (size_t i = 0; i < n; i++)
+        {
+            table[table.find(codes[i & (stream - 1)])].handler(sink);
+        }
+        double s = t.seconds();
+        printf("%-36s %10.2f %10.1f\n", "CommandTable (direct index)", s / n * 1e9, n / s / 1e6);
+    }
+    {
+        Timer t;
+        for (size_t i = 0; i < n; i++)
+        {
+            switch (codes[i & (stream - 1)])
+            {
+            case 1: handler<1>(sink); break;
+            case 2: handler<2>(sink); break;
+            case 3: handler<3>(sink); break;
+            case 4: handler<4>(sink); break;
+            case 5: handler<5>(sink); break;
+            case 6: handler<6>(sink); break;
+            case 7: handler<7>(sink); break;
+            case 8: handler<8>(sink); break;
+            case 9: handler<9>(sink); break;
+            case 10: handler<10>(sink); break;
+            case 11: handler<11>(sink); break;
+            }
+        }
+        double s = t.seconds();
+        printf("%-36s %10.2f %10.1f\n", "switch", s / n * 1e9, n / s / 1e6);
+    }
+
+    // every path must have run every command the same number of times
+    long long total = 0;
+    for (long long c : counts)
+    {
+        total += c;
+    }
+    do_not_optimize(sink);
+    bool ok = total == 4 * (long long)n;
+    printf("%s\n", ok ? "counts match" : "COUNT MISMATCH");
+    return ok ? 0 : 1;
+}
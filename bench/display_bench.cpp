@@ -0,0 +1,60 @@
+// Dumps the roster the old way (display_data() per student: cout with an
+// endl after every line) and through ReportWriter, and reports the time of
+// each on stderr. The roster itself goes to stdout, so compare runs with
+// and without a terminal attached:
+//   display_bench [students]              (terminal)
+//   display_bench [students] > /dev/null  (no terminal)
+//   display_bench [students] | cat        (pipe)
+// Default is 100000 students.
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "../reportwriter.h"
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    StudentRegistry registry;
+    registry.reserve(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        registry.add(make_student((int)i + 1, i));
+    }
+    fprintf(stderr, "students=%zu  stdout is %s\n", n, isatty(STDOUT_FILENO) ? "a terminal" : "not a terminal");
+
+    Timer old_t;
+    int i = 0;
+    registry.for_each([&](const Student& st)
+    {
+        cout << "Displaying data for student " << ++i << ":\n";
+        st.display_data();
+    });
+    cout.flush();
+    double old_s = old_t.seconds();
+
+    double fmt_s[3];
+    ReportFormat formats[3] = {ReportFormat::Text, ReportFormat::Csv, ReportFormat::Json};
+    for (int f = 0; f < 3; f++)
+    {
+        Timer t;
+        {
+            ReportWriter report(STDOUT_FILENO, formats[f]);
+            registry.for_each_row([&](int roll_no, const int* marks, string_view name)
+            {
+                report.row(roll_no, marks, name);
+            });
+        }
+        fmt_s[f] = t.seconds();
+    }
+
+    fprintf(stderr, "  display_data + endl  %9.1f ms\n", old_s * 1e3);
+    fprintf(stderr, "  ReportWriter text    %9.1f ms  (%.1fx)\n", fmt_s[0] * 1e3, old_s / fmt_s[0]);
+    fprintf(stderr, "  ReportWriter csv     %9.1f ms\n", fmt_s[1] * 1e3);
+    fprintf(stderr, "  ReportWriter json    %9.1f ms\n", fmt_s[2] * 1e3);
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Fibonacci terms: the old restart-from-F(0) loop of controlloops.cpp
+// against FibonacciStream for the first n terms, and fast doubling for the
+// single k-th term. The quadratic loop is only run up to 10^5 terms; the
+// streams are checked against each other and against fib_mod64.
+//   usage: fib_bench [terms] [k]   (default 1000000 10000000)
+#include <cstdio>
+#include <cstdlib>
+
+#include "../fibonacci.h"
+#include "benchutil.h"
+
+using namespace std;
+
+// the inner loop of the original program, in 64 bits
+static uint64_t restart_loop(uint64_t n)
+{
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        uint64_t a = 0, b = 1;
+        for (uint64_t j = 1; j < i; j++)
+        {
+            uint64_t t = a + b;
+            a = b;
+            b = t;
+        }
+        sum += i ? b : 0;
+    }
+    return sum;
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    uint64_t k = argc > 2 ? strtoull(argv[2], nullptr, 10) : 10000000;
+    bool ok = true;
+
+    printf("%-32s %12s %12s\n", "first n terms", "n", "ms");
+    for (uint64_t m = 1000; m <= n && m <= 100000; m *= 10)
+    {
+        Timer t;
+        do_not_optimize(restart_loop(m));
+        printf("%-32s %12llu %12.2f\n", "restart loop (mod 2^64)", (unsigned long long)m, t.seconds() * 1e3);
+    }
+    {
+        Timer t;
+        uint64_t a = 0, b = 1, sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            sum += a;
+            uint64_t c = a + b;
+            a = b;
+            b = c;
+        }
+        do_not_optimize(sum);
+        printf("%-32s %12llu %12.2f\n", "stream (mod 2^64)", (unsigned long long)n, t.seconds() * 1e3);
+    }
+    {
+        Timer t;
+        FibonacciStream<uint64_t> s;
+        while (s.next())
+        {
+        }
+        ok = ok && s.index() == fib_max_u64;
+        printf("%-32s %12llu %12.4f\n", "stream (checked, stops)", (unsigned long long)s.index() + 1, t.seconds() * 1e3);
+    }
+    {
+        Timer t;
+        FibonacciStream<BigInt> s;
+        for (uint64_t i = 1; i < n; i++)
+        {
+            s.next();
+        }
+        double ms = t.seconds() * 1e3;
+        ok = ok && s.term().low64() == fib_mod64(n - 1);
+        printf("%-32s %12llu %12.2f   F(n-1) has %zu bits\n", "stream (BigInt)", (unsigned long long)n, ms, s.term().bit_length());
+    }
+
+    printf("\n%-32s %12s %12s\n", "k-th term", "k", "ms");
+    {
+        Timer t;
+        uint64_t v = 0;
+        for (int r = 0; r < 1000000; r++)
+        {
+            v += fib_mod64(k + r);
+        }
+        do_not_optimize(v);
+        printf("%-32s %12llu %12.6f\n", "fast doubling (mod 2^64)", (unsigned long long)k, t.seconds() * 1e3 / 1e6);
+    }
+    {
+        Timer t;
+        BigInt f = fibonacci(k);
+        double ms = t.seconds() * 1e3;
+        ok = ok && f.low64() == fib_mod64(k);
+        printf("%-32s %12llu %12.2f   %zu bits\n", "fast doubling (BigInt)", (unsigned long long)k, ms, f.bit_length());
+    }
+
+    printf("%s\n", ok ? "results match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+// Letter-grade banding of student percentages: the if/else-if ladder in
+// the style of DecisionMaking.cpp against GradeBands at each SIMD level,
+// on random percentages and on the same values sorted. The ladder's
+// branches predict well on sorted input and badly on random input, so
+// the gap between its two columns is the misprediction cost; the
+// branch-free versions cost the same on both. Results are checked
+// against the ladder.
+//   usage: gradebands_bench [values]   (default 10000000)
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../gradebands.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static const int reps = 5;
+
+// same grades as GradeBands::letter_grades(), one condition at a time
+static void ladder(const float* x, size_t n, uint8_t* out)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        if (x[i] >= 90)
+        {
+            out[i] = 4;
+        }
+        else if (x[i] >= 80)
+        {
+            out[i] = 3;
+        }
+        else if (x[i] >= 70)
+        {
+            out[i] = 2;
+        }
+        else if (x[i] >= 60)
+        {
+            out[i] = 1;
+        }
+        else
+        {
+            out[i] = 0;
+        }
+    }
+}
+
+template <class F>
+static double best_ms(F f)
+{
+    double best = 1e9;
+    for (int r = 0; r < reps; r++)
+    {
+        Timer t;
+        f();
+        best = min(best, t.seconds() * 1e3);
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+    // whole marks out of 400, like student_percentages() produces
+    vector<float> random_input(n);
+    mt19937_64 rng(7);
+    for (float& p : random_input)
+    {
+        p = (float)(rng() % 401) * 100.0f / 400.0f;
+    }
+    vector<float> sorted_input = random_input;
+    sort(sorted_input.begin(), sorted_input.end());
+
+    GradeBands grades = GradeBands::letter_grades();
+    vector<uint8_t> expect(n), out(n);
+    bool ok = true;
+
+    printf("values=%zu  best=%s\n", n, simd_name(detect_simd()));
+    printf("%-20s %12s %12s\n", "classify", "random ms", "sorted ms");
+    const vector<float>* inputs[2] = {&random_input, &sorted_input};
+    double ms[2];
+    for (int k = 0; k < 2; k++)
+    {
+        ms[k] = best_ms([&] { ladder(inputs[k]->data(), n, expect.data()); });
+        do_not_optimize(expect[n / 2]);
+    }
+    printf("%-20s %12.2f %12.2f\n", "if/else ladder", ms[0], ms[1]);
+
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2})
+    {
+        if (level > detect_simd())
+        {
+            continue;
+        }
+        for (int k = 0; k < 2; k++)
+        {
+            ms[k] = best_ms([&] { grades.classify(inputs[k]->data(), n, out.data(), level); });
+            ladder(inputs[k]->data(), n, expect.data());
+            ok = ok && out == expect;
+        }
+        printf("bands %-14s %12.2f %12.2f\n", simd_name(level), ms[0], ms[1]);
+    }
+
+    printf("\n%-20s %12s %12s\n", "histogram", "random ms", "sorted ms");
+    size_t expect_counts[5] = {0};
+    for (int k = 0; k < 2; k++)
+    {
+        ms[k] = best_ms([&]
+        {
+            size_t c[5] = {0};
+            ladder(inputs[k]->data(), n, expect.data());
+            for (uint8_t b : expect)
+            {
+                c[b]++;
+            }
+            copy(c, c + 5, expect_counts);
+        });
+    }
+    printf("%-20s %12.2f %12.2f\n", "ladder + tally", ms[0], ms[1]);
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2})
+    {
+        if (level > detect_simd())
+        {
+            continue;
+        }
+        size_t counts[5];
+        for (int k = 0; k < 2; k++)
+        {
+            ms[k] = best_ms([&] { grades.count(inputs[k]->data(), n, counts, level); });
+            ok = ok && equal(counts, counts + 5, expect_counts);
+        }
+        printf("count %-14s %12.2f %12.2f\n", simd_name(level), ms[0], ms[1]);
+    }
+
+    printf("%s\n", ok ? "results match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
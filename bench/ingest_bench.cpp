@@ -0,0 +1,83 @@
+// Times --batch ingest of CSV records against an iostream parse of the
+// same text (getline for the name, >> for the numbers), both feeding a
+// StudentRegistry, and checks that reading the text back from a file
+// takes one buffer of the file's size.
+//   usage: ingest_bench [records]   (default 1000000)
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "../batchingest.h"
+#include "benchutil.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    vector<int> rolls = make_rolls(n);
+    string csv;
+    csv.reserve(n * 32);
+    csv += "name,roll_no,mark1,mark2,mark3,mark4\n";
+    for (size_t i = 0; i < n; i++)
+    {
+        Student st = make_student(rolls[i], i);
+        csv += st.get_name();
+        csv += ',' + to_string(st.get_roll_no());
+        for (int k = 0; k < 4; k++)
+        {
+            csv += ',' + to_string(st.get_marks(k));
+        }
+        csv += '\n';
+    }
+    printf("records=%zu  input=%.1f MB\n", n, csv.size() / 1e6);
+
+    {
+        StudentRegistry registry;
+        Timer t;
+        IngestResult r = ingest_records(csv, registry);
+        double s = t.seconds();
+        printf("  batch ingest  %8.1f ms  %6.1f Mrec/s  (%zu added, %zu bad)\n", s * 1e3,
+               n / s / 1e6, r.added, r.bad);
+    }
+    {
+        StudentRegistry registry;
+        Timer t;
+        istringstream in(csv);
+        string header, name;
+        getline(in, header);
+        int roll_no, marks[4];
+        char comma;
+        while (getline(in, name, ',') && in >> roll_no >> comma >> marks[0] >> comma >> marks[1] >>
+                                                comma >> marks[2] >> comma >> marks[3])
+        {
+            in.ignore();
+            registry.add(Student(name, roll_no, marks));
+        }
+        double s = t.seconds();
+        printf("  iostream      %8.1f ms  %6.1f Mrec/s  (%zu added)\n", s * 1e3, n / s / 1e6,
+               registry.size());
+    }
+
+    // read_input on the same text from a file: one buffer of the file's
+    // size, not a second one grown just to see end of file
+    bool ok = true;
+    {
+        char path[] = "/tmp/ingest_benchXXXXXX";
+        int fd = mkstemp(path);
+        ok = fd >= 0 && write(fd, csv.data(), csv.size()) == (ssize_t)csv.size();
+        close(fd);
+        string text, error;
+        Timer t;
+        ok = ok && read_input(path, text, error);
+        double s = t.seconds();
+        unlink(path);
+        printf("  read_input    %8.1f ms  buffer %.1f MB\n", s * 1e3, text.capacity() / 1e6);
+        ok = ok && text == csv && text.capacity() <= csv.size() + 4096;
+    }
+    printf("%s\n", ok ? "results match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
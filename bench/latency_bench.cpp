@@ -0,0 +1,164 @@
+// The cost of the latency instrumentation and the accuracy of what it
+// reports. Times a clock read (rdtsc against steady_clock), an empty
+// LatencyScope, and a mix of registry operations, which are timed
+// internally unless this file is built with -DLATENCY_DISABLED (build it
+// both ways to compare). Checks the histogram's percentiles against exact
+// ones from a sorted copy, and that recordings from several threads all
+// land in the merged snapshot.
+//   usage: latency_bench [students] [threads]   (default 1000000 4)
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../latency.h"
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t threads = argc > 2 ? strtoull(argv[2], nullptr, 10) : 4;
+    bool ok = true;
+    const size_t reps = 10000000;
+
+    printf("instrumentation %s\n%-36s %10s\n", latency_enabled ? "on" : "compiled out", "per call", "ns");
+    {
+        Timer t;
+        uint64_t sum = 0;
+        for (size_t i = 0; i < reps; i++)
+        {
+            sum += latency_ticks();
+        }
+        do_not_optimize(sum);
+        printf("%-36s %10.2f\n", "latency_ticks()", t.seconds() * 1e9 / reps);
+    }
+    {
+        Timer t;
+        uint64_t sum = 0;
+        for (size_t i = 0; i < reps; i++)
+        {
+            sum += latency_steady_ns();
+        }
+        do_not_optimize(sum);
+        printf("%-36s %10.2f\n", "steady_clock::now()", t.seconds() * 1e9 / reps);
+    }
+    {
+        Timer t;
+        for (size_t i = 0; i < reps; i++)
+        {
+            LatencyScope timed(LatencyRecorder::max_ops - 1);
+            do_not_optimize(i);
+        }
+        printf("%-36s %10.2f\n", "empty LatencyScope", t.seconds() * 1e9 / reps);
+    }
+
+    // registry operations: add, then find/update/delete in random order
+    StudentRegistry registry;
+    registry.reserve(n);
+    vector<int> rolls = make_rolls(n, 5);
+    {
+        Timer t;
+        for (int roll : rolls)
+        {
+            registry.add(make_student(roll, (uint64_t)roll));
+        }
+        printf("%-36s %10.1f\n", "registry add", t.seconds() * 1e9 / n);
+    }
+    {
+        Student st;
+        size_t found = 0;
+        Timer t;
+        for (int roll : rolls)
+        {
+            found += registry.get(roll, st);
+        }
+        printf("%-36s %10.1f\n", "registry find", t.seconds() * 1e9 / n);
+        ok = ok && found == n;
+    }
+    {
+        Timer t;
+        for (int roll : rolls)
+        {
+            registry.update(make_student(roll, (uint64_t)roll * 3));
+        }
+        printf("%-36s %10.1f\n", "registry update", t.seconds() * 1e9 / n);
+    }
+    {
+        Timer t;
+        for (size_t i = 0; i < n / 2; i++)
+        {
+            registry.remove(rolls[i]);
+        }
+        printf("%-36s %10.1f\n", "registry delete", t.seconds() * 1e9 / (n / 2));
+        ok = ok && registry.size() == n - n / 2;
+    }
+
+    if (latency_enabled)
+    {
+        LatencyRecorder& recorder = LatencyRecorder::instance();
+        double us = latency_ns_per_tick() / 1000.0;
+        printf("\n%-8s %10s %10s %10s %10s %10s\n", "op", "count", "p50 us", "p99 us", "p999 us", "max us");
+        const RegistryOp ops[] = {RegistryOp::Add, RegistryOp::Find, RegistryOp::Update, RegistryOp::Delete};
+        const size_t expected[] = {n, n, n, n / 2};
+        for (size_t k = 0; k < 4; k++)
+        {
+            LatencyHistogram h = recorder.snapshot((size_t)ops[k]);
+            printf("%-8s %10llu %10.3f %10.3f %10.3f %10.3f\n", registry_op_name(ops[k]),
+                   (unsigned long long)h.count(), h.percentile(50) * us, h.percentile(99) * us,
+                   h.percentile(99.9) * us, h.max() * us);
+            ok = ok && h.count() == expected[k];
+        }
+
+        // every thread's recordings reach the snapshot
+        const size_t op = LatencyRecorder::max_ops - 2, per_thread = 100000;
+        vector<thread> pool;
+        for (size_t t = 0; t < threads; t++)
+        {
+            pool.emplace_back([&, t]
+            {
+                for (size_t i = 0; i < per_thread; i++)
+                {
+                    recorder.record(op, 100 + t);
+                }
+            });
+        }
+        for (thread& t : pool)
+        {
+            t.join();
+        }
+        LatencyHistogram h = recorder.snapshot(op);
+        ok = ok && h.count() == threads * per_thread && h.max() == 100 + threads - 1;
+        printf("%zu threads recorded %llu values\n", threads, (unsigned long long)h.count());
+    }
+
+    // percentiles against exact ones, over latencies spread across decades
+    LatencyHistogram h;
+    vector<uint64_t> values(n);
+    mt19937_64 rng(3);
+    lognormal_distribution<double> spread(6.0, 2.0);
+    for (uint64_t& v : values)
+    {
+        v = (uint64_t)spread(rng);
+        h.record(v);
+    }
+    sort(values.begin(), values.end());
+    double worst = 0;
+    for (double p : {1.0, 10.0, 50.0, 90.0, 99.0, 99.9, 99.99, 100.0})
+    {
+        uint64_t exact = values[LatencyHistogram::rank_of(p, n) - 1];
+        uint64_t got = h.percentile(p);
+        // reported as the top of the exact value's bucket
+        ok = ok && got >= exact && got <= LatencyHistogram::bucket_high(LatencyHistogram::bucket_of(exact));
+        worst = max(worst, exact ? fabs((double)got - (double)exact) / (double)exact : 0.0);
+    }
+    ok = ok && h.max() == values.back() && h.count() == n;
+    printf("worst percentile error %.2f%% (bound %.2f%%)\n", worst * 100,
+           100.0 / LatencyHistogram::sub_buckets);
+
+    printf("%s\n", ok ? "results match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
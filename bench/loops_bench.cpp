@@ -0,0 +1,203 @@
+// The loop forms of loops.cpp (loopkernels.h) timed against each other:
+// for, while and do-while sums, an early exit with break against one in a
+// while condition, and a filter with continue against one with an if.
+// Each kernel runs over arrays sized for L1, L2 and main memory, pinned
+// to one CPU, with warm-up runs and repeated timed runs; the table gives
+// the median and minimum time per element, the spread of the runs, and,
+// where perf_event_open is permitted, IPC, instructions and branch misses
+// per element. Kernels of a group whose machine code is the same are
+// marked, and --asm FILE writes every kernel's disassembly.
+//   usage: loops_bench [--cpu N] [--reps R] [--warmup W] [--asm FILE] [elements...]
+//          (default pinned to the current CPU, 21 reps, 3 warm-up, 4096 262144 16777216)
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../loopkernels.h"
+#include "perfharness.h"
+
+using namespace std;
+
+// the instructions without addresses or the function's own name, so two
+// kernels compiled to the same code compare equal
+static string normalized(const string& code)
+{
+    string out;
+    size_t begin = 0;
+    while (begin < code.size())
+    {
+        size_t end = min(code.find('\n', begin), code.size());
+        string line = code.substr(begin, end - begin);
+        begin = end + 1;
+        // "    8796:\tje ..." loses its address column; the label line
+        // "0000000000008790 <name>:" goes altogether
+        size_t hex = line.find_first_not_of(' ');
+        size_t colon = hex == string::npos ? hex : line.find_first_not_of("0123456789abcdef", hex);
+        if (colon != string::npos && colon > hex && line[colon] == ':')
+        {
+            line.erase(0, line.find_first_not_of(" \t", colon + 1));
+        }
+        else if (line.find(">:") != string::npos)
+        {
+            continue;
+        }
+        // jump and call targets: "8848 <name+0xb8>" becomes "+0xb8>"
+        for (size_t open; (open = line.find(" <")) != string::npos;)
+        {
+            size_t start = open;
+            while (start > 0 && isxdigit((unsigned char)line[start - 1]))
+            {
+                start--;
+            }
+            size_t stop = min(line.find_first_of(">+", open + 2), line.size());
+            line.erase(start, stop - start);
+        }
+        out += line;
+        out += '\n';
+    }
+    return out;
+}
+
+int main(int argc, char** argv)
+{
+    int cpu = -1;
+    size_t reps = 21, warmup = 3;
+    string asm_path;
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--cpu" && i + 1 < argc)
+        {
+            cpu = atoi(argv[++i]);
+        }
+        else if (arg == "--reps" && i + 1 < argc)
+        {
+            reps = max<size_t>(1, strtoull(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--warmup" && i + 1 < argc)
+        {
+            warmup = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--asm" && i + 1 < argc)
+        {
+            asm_path = argv[++i];
+        }
+        else
+        {
+            sizes.push_back(strtoull(argv[i], nullptr, 10));
+        }
+    }
+    if (sizes.empty())
+    {
+        sizes = {4096, 262144, 16777216};
+    }
+
+    int pinned = pin_to_cpu(cpu);
+    PerfCounters counters;
+    printf("pinned to cpu %d, %zu warm-up + %zu timed runs, hardware counters %s\n", pinned, warmup, reps,
+           counters.available() ? "on" : "unavailable");
+
+    const size_t kernels = sizeof(loop_kernels) / sizeof(loop_kernels[0]);
+    vector<string> code(kernels);
+    for (size_t k = 0; k < kernels; k++)
+    {
+        code[k] = disassemble((const void*)loop_kernels[k].kernel);
+    }
+    if (!asm_path.empty())
+    {
+        FILE* f = fopen(asm_path.c_str(), "w");
+        if (!f)
+        {
+            perror(asm_path.c_str());
+            return 1;
+        }
+        for (size_t k = 0; k < kernels; k++)
+        {
+            fprintf(f, "# %s: %s\n%s\n", loop_kernels[k].group, loop_kernels[k].name,
+                    code[k].empty() ? "(not available)\n" : code[k].c_str());
+        }
+        fclose(f);
+        printf("disassembly written to %s\n", asm_path.c_str());
+    }
+
+    bool ok = true;
+    mt19937_64 rng(21);
+    for (size_t n : sizes)
+    {
+        vector<int> a(n);
+        for (int& x : a)
+        {
+            x = (int)(rng() % 100);
+        }
+        // find stops three quarters of the way in; filter keeps half the values
+        const int find_key = -1;
+        if (n > 0)
+        {
+            a[n - n / 4 - 1] = find_key;
+        }
+        // small arrays are run several times per timed run
+        size_t inner = max<size_t>(1, (size_t(1) << 22) / max<size_t>(n, 1));
+
+        printf("\nelements=%zu (%zu KB)\n%-7s %-16s %9s %9s %7s %6s %9s %9s  %s\n", n, n * sizeof(int) / 1024,
+               "group", "form", "med ns/el", "min ns/el", "cv %", "IPC", "instr/el", "brmiss/el", "code");
+        long long first_result = 0;
+        for (size_t k = 0; k < kernels; k++)
+        {
+            const LoopKernelInfo& info = loop_kernels[k];
+            int key = strcmp(info.group, "find") == 0 ? find_key : 50;
+            long long result = 0;
+            vector<double> times = time_runs([&]
+            {
+                for (size_t r = 0; r < inner; r++)
+                {
+                    do_not_optimize(a.data());
+                    result = info.kernel(a.data(), n, key);
+                    do_not_optimize(result);
+                }
+            }, warmup, reps, &counters);
+            RunStats s = summarize_runs(times);
+            double per = 1e9 / ((double)inner * (double)max<size_t>(n, 1));
+            double elements = (double)reps * (double)inner * (double)max<size_t>(n, 1);
+
+            // the first kernel of each group sets the result the others must match
+            size_t first = k;
+            while (first > 0 && strcmp(loop_kernels[first - 1].group, info.group) == 0)
+            {
+                first--;
+            }
+            if (first == k)
+            {
+                first_result = result;
+            }
+            ok = ok && result == first_result;
+            string same = "";
+            if (first != k && !code[k].empty() && normalized(code[k]) == normalized(code[first]))
+            {
+                same = string("same as ") + loop_kernels[first].name;
+            }
+            else if (first != k && info.kernel == loop_kernels[first].kernel)
+            {
+                same = string("folded into ") + loop_kernels[first].name;
+            }
+
+            if (counters.available())
+            {
+                printf("%-7s %-16s %9.3f %9.3f %7.2f %6.2f %9.2f %9.4f  %s\n", info.group, info.name,
+                       s.median * per, s.min * per, s.cv(), counters.ipc(), counters.instructions / elements,
+                       counters.branch_misses / elements, same.c_str());
+            }
+            else
+            {
+                printf("%-7s %-16s %9.3f %9.3f %7.2f %6s %9s %9s  %s\n", info.group, info.name, s.median * per,
+                       s.min * per, s.cv(), "-", "-", "-", same.c_str());
+            }
+        }
+    }
+
+    printf("%s\n", ok ? "results match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
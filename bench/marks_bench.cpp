@@ -0,0 +1,83 @@
+// Runs the mark-column kernels (totals, percentages, per-column
+// sum/min/max) at every SIMD level the CPU supports and reports time and
+// effective bandwidth. Results are checked against the scalar kernels.
+//   usage: marks_bench [students]   (default 10000000)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static const int reps = 5;
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+    StudentRegistry registry;
+    registry.reserve(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        registry.add(make_student((int)i + 1, i));
+    }
+    MarkColumns m = registry.mark_columns();
+
+    vector<int> ref_totals(n), totals(n);
+    vector<float> ref_percent(n), percent(n);
+    student_totals(m, ref_totals.data(), SimdLevel::Scalar);
+    student_percentages(m, ref_percent.data(), 400, SimdLevel::Scalar);
+    ColumnStats ref_stats[4];
+    for (int k = 0; k < 4; k++)
+    {
+        ref_stats[k] = column_stats(m.col[k], n, SimdLevel::Scalar);
+    }
+
+    double in_mb = 4.0 * n * sizeof(int) / 1e6;
+    printf("students=%zu  best=%s\n", n, simd_name(detect_simd()));
+    printf("%-8s %14s %14s %14s\n", "level", "totals ms", "percent ms", "min/max/avg ms");
+
+    bool ok = true;
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2})
+    {
+        if (level > detect_simd())
+        {
+            continue;
+        }
+        double best[3] = {1e9, 1e9, 1e9};
+        for (int r = 0; r < reps; r++)
+        {
+            Timer t0;
+            student_totals(m, totals.data(), level);
+            best[0] = min(best[0], t0.seconds());
+
+            Timer t1;
+            student_percentages(m, percent.data(), 400, level);
+            best[1] = min(best[1], t1.seconds());
+
+            Timer t2;
+            ColumnStats stats[4];
+            for (int k = 0; k < 4; k++)
+            {
+                stats[k] = column_stats(m.col[k], n, level);
+            }
+            best[2] = min(best[2], t2.seconds());
+
+            for (int k = 0; k < 4; k++)
+            {
+                ok = ok && stats[k].sum == ref_stats[k].sum && stats[k].min == ref_stats[k].min &&
+                     stats[k].max == ref_stats[k].max;
+            }
+        }
+        ok = ok && totals == ref_totals &&
+             memcmp(percent.data(), ref_percent.data(), n * sizeof(float)) == 0;
+        printf("%-8s %8.2f (%4.1f GB/s) %6.2f (%4.1f GB/s) %6.2f (%4.1f GB/s)\n", simd_name(level),
+               best[0] * 1e3, (in_mb + n * 4 / 1e6) / best[0] / 1e3,
+               best[1] * 1e3, (in_mb + n * 4 / 1e6) / best[1] / 1e3,
+               best[2] * 1e3, in_mb / best[2] / 1e3);
+    }
+    printf("%s\n", ok ? "results match scalar" : "MISMATCH against scalar");
+    return ok ? 0 : 1;
+}
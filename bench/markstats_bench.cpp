@@ -0,0 +1,229 @@
+// Class statistics over the mark columns: the one-pass counting
+// MarkDistribution against a two-pass mean/variance plus a sort for
+// percentiles, and against Welford's running mean/variance. Every result
+// is checked: sums, minima, maxima and percentiles exactly, mean and
+// variance against an exact 128-bit reference, per-student summaries
+// against the formulas they replace, and the registry's cached summary of
+// one row across updates. Also times the registry's cached statistics()
+// before and after an update.
+//   usage: markstats_bench [students]   (default 10000000)
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../marksstats.h"
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+struct Moments
+{
+    double mean, variance;
+};
+
+static Moments two_pass(const vector<int>& v)
+{
+    double sum = 0;
+    for (int x : v)
+    {
+        sum += x;
+    }
+    double mean = sum / v.size(), sq = 0;
+    for (int x : v)
+    {
+        sq += (x - mean) * (x - mean);
+    }
+    return {mean, sq / v.size()};
+}
+
+static Moments welford(const vector<int>& v)
+{
+    double mean = 0, m2 = 0;
+    size_t n = 0;
+    for (int x : v)
+    {
+        n++;
+        double d = x - mean;
+        mean += d / n;
+        m2 += d * (x - mean);
+    }
+    return {mean, m2 / n};
+}
+
+// the exact values, rounded once
+static Moments exact(const vector<int>& v)
+{
+    __int128 sum = 0;
+    unsigned __int128 sq = 0;
+    for (int x : v)
+    {
+        sum += x;
+        sq += (unsigned __int128)((long long)x * x);
+    }
+    return {(double)sum / (double)v.size(), exact_variance(v.size(), sum, sq)};
+}
+
+static int nearest_rank(const vector<int>& sorted, double p)
+{
+    size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+    rank = min(max(rank, (size_t)1), sorted.size());
+    return sorted[rank - 1];
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+    vector<int> cols[4], totals(n);
+    mt19937_64 rng(11);
+    for (vector<int>& c : cols)
+    {
+        c.resize(n);
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t r = rng();
+        for (int k = 0; k < 4; k++)
+        {
+            // a few marks outside 0..100 exercise the outlier path
+            cols[k][i] = (int)((r >> (16 * k)) % 101);
+            if ((r >> (16 * k + 8) & 0xFFF) == 0)
+            {
+                cols[k][i] = -cols[k][i] - 1;
+            }
+        }
+        totals[i] = cols[0][i] + cols[1][i] + cols[2][i] + cols[3][i];
+    }
+    MarkColumns m{{cols[0].data(), cols[1].data(), cols[2].data(), cols[3].data()}, n};
+    const double ps[] = {1, 25, 50, 75, 90, 99, 99.9};
+    bool ok = true;
+
+    printf("students=%zu\n%-40s %10s\n", n, "class statistics (4 columns + totals)", "ms");
+    ClassStatistics stats;
+    {
+        Timer t;
+        class_statistics(m, stats);
+        int p = 0;
+        for (double q : ps)
+        {
+            p += stats.totals.percentile(q);
+        }
+        do_not_optimize(p);
+        do_not_optimize(stats.totals.variance());
+        printf("%-40s %10.1f\n", "one pass, counting", t.seconds() * 1e3);
+    }
+    vector<int> sorted[5];
+    {
+        Timer t;
+        for (int k = 0; k < 5; k++)
+        {
+            const vector<int>& v = k < 4 ? cols[k] : totals;
+            Moments mo = two_pass(v);
+            do_not_optimize(mo);
+            sorted[k] = v;
+            sort(sorted[k].begin(), sorted[k].end());
+        }
+        printf("%-40s %10.1f\n", "two-pass moments + sort", t.seconds() * 1e3);
+    }
+    {
+        Timer t;
+        for (int k = 0; k < 5; k++)
+        {
+            Moments mo = welford(k < 4 ? cols[k] : totals);
+            do_not_optimize(mo);
+        }
+        printf("%-40s %10.1f\n", "Welford moments only", t.seconds() * 1e3);
+    }
+
+    // exactness
+    double worst[3] = {0, 0, 0};  // relative variance error: counting, two-pass, Welford
+    for (int k = 0; k < 5; k++)
+    {
+        const vector<int>& v = k < 4 ? cols[k] : totals;
+        const MarkDistribution& d = k < 4 ? stats.marks[k] : stats.totals;
+        Moments ref = exact(v);
+        Moments got[3] = {{d.mean(), d.variance()}, two_pass(v), welford(v)};
+        for (int a = 0; a < 3; a++)
+        {
+            worst[a] = max(worst[a], fabs(got[a].variance - ref.variance) / ref.variance);
+        }
+        ok = ok && d.mean() == ref.mean && d.variance() == ref.variance;
+        ok = ok && d.min() == sorted[k].front() && d.max() == sorted[k].back();
+        for (double q : ps)
+        {
+            ok = ok && d.percentile(q) == nearest_rank(sorted[k], q);
+        }
+    }
+    printf("\nworst relative variance error: counting %.3g, two-pass %.3g, Welford %.3g\n", worst[0], worst[1],
+           worst[2]);
+
+    // per-student summaries, and the percentage formula operator.cpp had
+    size_t truncated = 0;
+    for (size_t i = 0; i < min<size_t>(n, 100000); i++)
+    {
+        int row[4] = {cols[0][i], cols[1][i], cols[2][i], cols[3][i]};
+        Student st("S", (int)i, row);
+        MarkSummary s = st.summary();
+        double mean = totals[i] / 4.0, var = 0;
+        for (int x : row)
+        {
+            var += (x - mean) * (x - mean) / 4.0;
+        }
+        ok = ok && s.total == totals[i] && s.percent == totals[i] * 100.0 / 400 && s.mean == mean &&
+             fabs(s.variance - var) <= 1e-12 * max(var, 1.0);
+        truncated += (totals[i] / 400) * 100 != (int)s.percent;
+    }
+    printf("integer-division percentages wrong for %zu of %zu students\n", truncated, min<size_t>(n, 100000));
+
+    // the registry's cache
+    StudentRegistry registry;
+    registry.reserve(n);
+    registry.defer_indexes();
+    for (size_t i = 0; i < n; i++)
+    {
+        int row[4] = {cols[0][i], cols[1][i], cols[2][i], cols[3][i]};
+        registry.add("S", (int)i + 1, row);
+    }
+
+    // the registry's summary column across an update and a delete that
+    // moves the last row into the hole
+    int zero[4] = {0, 0, 0, 0}, first[4] = {cols[0][0], cols[1][0], cols[2][0], cols[3][0]};
+    MarkSummary before, after;
+    ok = ok && registry.summary(1, before) && before.total == totals[0] && registry.summary((int)n, after);
+    registry.update(Student("S", 1, zero));
+    ok = ok && registry.summary(1, after) && after.total == 0 && after.variance == 0;
+    registry.update(Student("S", 1, first));
+    ok = ok && registry.summary(1, after) && after.total == before.total && after.variance == before.variance;
+    registry.remove(1);
+    ok = ok && !registry.summary(1, after) &&
+         (n == 1 || (registry.summary((int)n, after) && after.total == totals[n - 1]));
+    registry.add("S", 1, first);
+    ok = ok && registry.summary(1, after) && after.total == totals[0];
+
+    printf("\n%-40s %10s\n", "registry statistics()", "ms");
+    const char* labels[] = {"first call", "cached", "after one update"};
+    for (int step = 0; step < 3; step++)
+    {
+        if (step == 2)
+        {
+            registry.update(Student("S", 1, zero));
+        }
+        Timer t;
+        const ClassStatistics& s = registry.statistics();
+        double ms = t.seconds() * 1e3;
+        printf("%-40s %10.3f\n", labels[step], ms);
+        ok = ok && s.count() == n;
+        if (step < 2)
+        {
+            ok = ok && s.totals.sum() == stats.totals.sum();
+        }
+        else
+        {
+            ok = ok && s.totals.sum() == stats.totals.sum() - totals[0];
+        }
+    }
+
+    printf("%s\n", ok ? "results match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+// Prefix and range queries through the registry's name index against a
+// linear scan comparing every name, on randomly generated names.
+//   usage: nameindex_bench [students...]   (default 100000 1000000)
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static string random_name(mt19937_64& rng)
+{
+    static const char* syllables[] = {"al", "an", "be", "ca", "da", "el", "fa", "ha", "is", "jo",
+                                      "ka", "li", "ma", "na", "or", "pe", "ra", "sa", "ti", "vi"};
+    int parts = 2 + (int)(rng() % 3);
+    string name;
+    for (int i = 0; i < parts; i++)
+    {
+        name += syllables[rng() % 20];
+    }
+    name[0] = (char)(name[0] - 'a' + 'A');
+    return name;
+}
+
+static void run(size_t n)
+{
+    mt19937_64 rng(n);
+    vector<string> names;
+    for (size_t i = 0; i < n; i++)
+    {
+        names.push_back(random_name(rng));
+    }
+    int marks[4] = {50, 60, 70, 80};
+
+    // incremental: the index is updated on every add
+    Timer incremental;
+    {
+        StudentRegistry registry;
+        registry.reserve(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            registry.add(names[i], (int)i + 1, marks);
+        }
+    }
+    double incremental_s = incremental.seconds();
+
+    // bulk: deferred, then rebuilt by the first query
+    StudentRegistry registry;
+    Timer bulk;
+    registry.reserve(n);
+    registry.defer_indexes();
+    for (size_t i = 0; i < n; i++)
+    {
+        registry.add(names[i], (int)i + 1, marks);
+    }
+    registry.find_by_prefix("A", [](string_view, int) {}, 1);
+    printf("students=%zu  load+index: incremental %.1f ms, deferred bulk %.1f ms\n", n,
+           incremental_s * 1e3, bulk.seconds() * 1e3);
+
+    vector<string> prefixes;
+    for (int i = 0; i < 200; i++)
+    {
+        string p = random_name(rng);
+        p.resize(3 + i % 4);  // 3..6 characters
+        prefixes.push_back(p);
+    }
+
+    size_t scan_queries = 20;
+    size_t matches = 0;
+    Timer scan;
+    for (size_t q = 0; q < scan_queries; q++)
+    {
+        const string& p = prefixes[q];
+        registry.for_each_row([&](int, const int*, string_view name)
+        {
+            if (name.compare(0, p.size(), p) == 0)
+            {
+                matches++;
+            }
+        });
+    }
+    double scan_s = scan.seconds() / scan_queries;
+
+    size_t indexed = 0;
+    Timer idx;
+    for (const string& p : prefixes)
+    {
+        indexed += registry.find_by_prefix(p, [](string_view, int) {});
+    }
+    double idx_s = idx.seconds() / prefixes.size();
+
+    size_t ranged = 0;
+    Timer rng_t;
+    for (size_t q = 0; q + 1 < prefixes.size(); q += 2)
+    {
+        string lo = min(prefixes[q], prefixes[q + 1]);
+        string hi = lo + "z";
+        ranged += registry.find_by_name_range(lo, hi, [](string_view, int) {});
+    }
+    double range_s = rng_t.seconds() / (prefixes.size() / 2);
+
+    printf("  prefix  linear scan %10.1f us/query  (%.1f matches/query)\n", scan_s * 1e6,
+           (double)matches / scan_queries);
+    printf("  prefix  name index  %10.2f us/query  (%.1f matches/query)\n", idx_s * 1e6,
+           (double)indexed / prefixes.size());
+    printf("  range   name index  %10.2f us/query  (%.1f matches/query)\n", range_s * 1e6,
+           (double)ranged / (prefixes.size() / 2));
+}
+
+int main(int argc, char** argv)
+{
+    for (size_t n : sizes_from_args(argc, argv, {100000, 1000000}))
+    {
+        run(n);
+    }
+    return 0;
+}
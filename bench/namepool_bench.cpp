@@ -0,0 +1,145 @@
+// Heap allocations and resident memory for loading a roster with
+// realistic (longer than the small-string buffer) names:
+//   students  - the original layout, a vector of Student each owning a
+//               std::string name
+//   strings   - just a column of std::string names
+//   pool      - the same names appended to a NamePool
+//   registry  - a full StudentRegistry load (names in its pool), with the
+//               name and total indexes kept current on every add
+// Each case runs in its own child process so RSS numbers don't share a
+// heap. RSS is the growth of the resident set over the load.
+//   usage: namepool_bench [records]   (default 1000000)
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../namepool.h"
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static size_t allocations = 0;
+
+// kept out of line: inlined into a caller, GCC pairs the free() below
+// with the new-expression there and warns of a mismatched deallocation
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    allocations++;
+    if (void* p = malloc(size))
+    {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+static double rss_mb()
+{
+    long pages = 0, resident = 0;
+    if (FILE* f = fopen("/proc/self/statm", "r"))
+    {
+        if (fscanf(f, "%ld %ld", &pages, &resident) != 2)
+        {
+            resident = 0;
+        }
+        fclose(f);
+    }
+    return resident * (double)sysconf(_SC_PAGESIZE) / (1024 * 1024);
+}
+
+static void name_of(int roll_no, char* out)
+{
+    snprintf(out, 48, "Student %07d of the class", roll_no);
+}
+
+static void load(const char* which, size_t n)
+{
+    char name[48];
+    int marks[4] = {50, 60, 70, 80};
+    double rss = rss_mb();
+    size_t before = allocations;
+    Timer t;
+    size_t check = 0;
+    if (string(which) == "students")
+    {
+        vector<Student> s;
+        for (size_t i = 0; i < n; i++)
+        {
+            name_of((int)i + 1, name);
+            s.emplace_back(name, (int)i + 1, marks);
+        }
+        check = s.size();
+        printf("%-10s %12zu %10.1f %10.3f\n", which, allocations - before, rss_mb() - rss, t.seconds());
+    }
+    else if (string(which) == "strings")
+    {
+        vector<string> names;
+        for (size_t i = 0; i < n; i++)
+        {
+            name_of((int)i + 1, name);
+            names.emplace_back(name);
+        }
+        check = names.size();
+        printf("%-10s %12zu %10.1f %10.3f\n", which, allocations - before, rss_mb() - rss, t.seconds());
+    }
+    else if (string(which) == "pool")
+    {
+        NamePool pool;
+        vector<NameRef> names;
+        for (size_t i = 0; i < n; i++)
+        {
+            name_of((int)i + 1, name);
+            names.emplace_back();
+            pool.append(name, names.back());
+        }
+        check = names.size();
+        printf("%-10s %12zu %10.1f %10.3f\n", which, allocations - before, rss_mb() - rss, t.seconds());
+    }
+    else
+    {
+        StudentRegistry registry;
+        for (size_t i = 0; i < n; i++)
+        {
+            name_of((int)i + 1, name);
+            registry.add(name, (int)i + 1, marks);
+        }
+        check = registry.size();
+        printf("%-10s %12zu %10.1f %10.3f\n", which, allocations - before, rss_mb() - rss, t.seconds());
+    }
+    do_not_optimize(check);
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    printf("%zu records\n%-10s %12s %10s %10s\n", n, "layout", "allocations", "RSS MB", "seconds");
+    fflush(stdout);
+    for (const char* which : {"students", "strings", "pool", "registry"})
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            load(which, n);
+            fflush(stdout);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+    }
+    return 0;
+}
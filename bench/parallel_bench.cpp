@@ -0,0 +1,199 @@
+// Scaling of the registry's bulk jobs on a TaskPool (taskpool.h): range
+// validation, totals, grade-band counts and a CSV listing to /dev/null,
+// each run serially and then on 1, 2, 4, ... up to the given number of
+// threads. Reports the best of three runs and the speedup over the
+// one-thread pool, and checks every parallel result, including the bytes
+// of a listing, against the serial one.
+//   usage: parallel_bench [students] [max threads]   (default 10000000, one per core)
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../gradebands.h"
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static double best_of(int reps, const function<void()>& f)
+{
+    double best = 1e30;
+    for (int r = 0; r < reps; r++)
+    {
+        Timer t;
+        f();
+        best = min(best, t.seconds());
+    }
+    return best;
+}
+
+static void fill(StudentRegistry& registry, size_t n)
+{
+    registry.reserve(n);
+    registry.defer_indexes();
+    uint64_t seed = 7;
+    for (size_t i = 0; i < n; i++)
+    {
+        int marks[4];
+        for (int k = 0; k < 4; k++)
+        {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            // one mark in about a thousand is out of range
+            marks[k] = (int)((seed >> 33) % 1000) == 0 ? 101 : (int)((seed >> 40) % 101);
+        }
+        int roll_no = (int)i + 1;
+        registry.add("S" + to_string(roll_no), roll_no, marks);
+    }
+}
+
+static string read_file(const char* path)
+{
+    string text;
+    FILE* f = fopen(path, "rb");
+    char block[65536];
+    size_t got;
+    while (f && (got = fread(block, 1, sizeof(block), f)) > 0)
+    {
+        text.append(block, got);
+    }
+    if (f)
+    {
+        fclose(f);
+    }
+    return text;
+}
+
+// the listing from a pool against one written row by row
+static bool listing_matches(StudentRegistry& registry, TaskPool& pool, ReportFormat format)
+{
+    char serial_path[] = "/tmp/parallel_benchXXXXXX", pool_path[] = "/tmp/parallel_benchXXXXXX";
+    int serial_fd = mkstemp(serial_path), pool_fd = mkstemp(pool_path);
+    {
+        ReportWriter report(serial_fd, format);
+        registry.for_each_row([&](int roll_no, const int* marks, string_view name)
+        {
+            report.row(roll_no, marks, name);
+        });
+    }
+    registry.write_report(pool, pool_fd, format);
+    close(serial_fd);
+    close(pool_fd);
+    bool same = read_file(serial_path) == read_file(pool_path);
+    unlink(serial_path);
+    unlink(pool_path);
+    return same;
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+    size_t max_threads = argc > 2 ? strtoull(argv[2], nullptr, 10) : 0;
+    if (max_threads == 0)
+    {
+        max_threads = max(1u, thread::hardware_concurrency());
+    }
+    const int reps = 3;
+    bool ok = true;
+
+    StudentRegistry registry;
+    fill(registry, n);
+    GradeBands grades = GradeBands::letter_grades();
+    int null_fd = open("/dev/null", O_WRONLY);
+
+    // serial references
+    MarkColumns m = registry.mark_columns();
+    size_t serial_bad = 0;
+    vector<int> serial_totals(n), totals(n);
+    vector<float> percent(n);
+    vector<size_t> serial_counts(grades.size()), counts(grades.size());
+    double serial_s[4];
+    serial_s[0] = best_of(reps, [&]
+    {
+        serial_bad = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            bool out = false;
+            for (int k = 0; k < 4; k++)
+            {
+                out |= m.col[k][i] < 0 || m.col[k][i] > 100;
+            }
+            serial_bad += out;
+        }
+    });
+    serial_s[1] = best_of(reps, [&] { student_totals(m, serial_totals.data()); });
+    serial_s[2] = best_of(reps, [&]
+    {
+        student_percentages(m, percent.data());
+        grades.count(percent.data(), n, serial_counts.data());
+    });
+    serial_s[3] = best_of(reps, [&]
+    {
+        ReportWriter report(null_fd, ReportFormat::Csv);
+        registry.for_each_row([&](int roll_no, const int* marks, string_view name)
+        {
+            report.row(roll_no, marks, name);
+        });
+    });
+
+    const char* jobs[4] = {"validate", "totals", "grades", "csv listing"};
+    printf("%zu students, %u hardware threads, chunks of %zu rows\n", n, thread::hardware_concurrency(),
+           StudentRegistry::bulk_grain);
+    printf("%-12s %8s %10s %9s\n", "job", "threads", "ms", "speedup");
+    for (int j = 0; j < 4; j++)
+    {
+        printf("%-12s %8s %10.2f\n", jobs[j], "serial", serial_s[j] * 1e3);
+    }
+
+    vector<size_t> thread_counts;
+    for (size_t t = 1; t < max_threads; t *= 2)
+    {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(max_threads);
+    double one_thread[4] = {0, 0, 0, 0};
+    for (size_t t : thread_counts)
+    {
+        TaskPool pool(t);
+        double s[4];
+        size_t bad = 0;
+        s[0] = best_of(reps, [&] { bad = registry.count_out_of_range(pool); });
+        s[1] = best_of(reps, [&] { registry.totals(pool, totals.data()); });
+        s[2] = best_of(reps, [&] { registry.grade_counts(pool, grades, counts.data()); });
+        s[3] = best_of(reps, [&] { registry.write_report(pool, null_fd, ReportFormat::Csv); });
+        for (int j = 0; j < 4; j++)
+        {
+            if (t == 1)
+            {
+                one_thread[j] = s[j];
+            }
+            printf("%-12s %8zu %10.2f %8.2fx\n", jobs[j], t, s[j] * 1e3, one_thread[j] / s[j]);
+        }
+        if (bad != serial_bad || totals != serial_totals || counts != serial_counts)
+        {
+            printf("MISMATCH with %zu threads\n", t);
+            ok = false;
+        }
+    }
+    close(null_fd);
+
+    // the bytes of every format, on a registry small enough to hold twice
+    StudentRegistry sample;
+    fill(sample, min<size_t>(n, 200000));
+    TaskPool pool(max_threads);
+    for (ReportFormat format : {ReportFormat::Text, ReportFormat::Csv, ReportFormat::Json})
+    {
+        if (!listing_matches(sample, pool, format))
+        {
+            printf("MISMATCH in a listing\n");
+            ok = false;
+        }
+    }
+    printf(ok ? "results match\n" : "results differ\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,280 @@
+// Repetition harness for micro-benchmarks: pins the process to one CPU,
+// runs a kernel through warm-up and timed repetitions, summarizes the
+// times, and reads hardware counters with perf_event_open where the
+// kernel allows it (perf_event_paranoid <= 2 and a PMU the VM exposes).
+// disassemble() writes a function's machine code, looked up by address
+// with nm and printed with objdump, so the timings can be read next to
+// the code the compiler produced.
+#ifndef PERFHARNESS_H
+#define PERFHARNESS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "benchutil.h"
+
+// cpu < 0 pins to the CPU the process is on now
+inline int pin_to_cpu(int cpu)
+{
+    if (cpu < 0)
+    {
+        cpu = sched_getcpu();
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return cpu >= 0 && sched_setaffinity(0, sizeof(set), &set) == 0 ? cpu : -1;
+}
+
+struct RunStats
+{
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double stddev = 0;
+
+    // coefficient of variation, in percent
+    double cv() const
+    {
+        return mean > 0 ? stddev / mean * 100.0 : 0.0;
+    }
+};
+
+inline RunStats summarize_runs(std::vector<double> v)
+{
+    RunStats s;
+    if (v.empty())
+    {
+        return s;
+    }
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    s.min = v.front();
+    s.median = n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+    for (double x : v)
+    {
+        s.mean += x;
+    }
+    s.mean /= (double)n;
+    for (double x : v)
+    {
+        s.stddev += (x - s.mean) * (x - s.mean);
+    }
+    s.stddev = n > 1 ? std::sqrt(s.stddev / (double)(n - 1)) : 0.0;
+    return s;
+}
+
+// cycles, instructions and branch misses of this thread in user space,
+// counted as one group so they cover exactly the same interval
+class PerfCounters
+{
+public:
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t branch_misses = 0;
+
+    PerfCounters()
+    {
+        const uint64_t configs[3] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                     PERF_COUNT_HW_BRANCH_MISSES};
+        for (int k = 0; k < 3; k++)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[k];
+            attr.disabled = k == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            fds[k] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, k == 0 ? -1 : fds[0], 0);
+            if (fds[k] < 0)
+            {
+                close_all();
+                return;
+            }
+        }
+    }
+
+    ~PerfCounters()
+    {
+        close_all();
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const
+    {
+        return fds[0] >= 0;
+    }
+
+    void start()
+    {
+        if (available())
+        {
+            ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    // false if the counters could not be read
+    bool stop()
+    {
+        if (!available())
+        {
+            return false;
+        }
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t values[4];
+        if (read(fds[0], values, sizeof(values)) != (ssize_t)sizeof(values) || values[0] != 3)
+        {
+            return false;
+        }
+        cycles = values[1];
+        instructions = values[2];
+        branch_misses = values[3];
+        return true;
+    }
+
+    double ipc() const
+    {
+        return cycles ? (double)instructions / (double)cycles : 0.0;
+    }
+
+private:
+    int fds[3] = {-1, -1, -1};
+
+    void close_all()
+    {
+        for (int& fd : fds)
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+            fd = -1;
+        }
+    }
+};
+
+// times of reps calls of f after warmup untimed ones, in seconds; the
+// counters, if given and available, cover the timed calls only
+template <class F>
+inline std::vector<double> time_runs(F f, size_t warmup, size_t reps, PerfCounters* counters = nullptr)
+{
+    for (size_t r = 0; r < warmup; r++)
+    {
+        f();
+    }
+    std::vector<double> times(reps);
+    if (counters)
+    {
+        counters->start();
+    }
+    for (size_t r = 0; r < reps; r++)
+    {
+        Timer t;
+        f();
+        times[r] = t.seconds();
+    }
+    if (counters)
+    {
+        counters->stop();
+    }
+    return times;
+}
+
+// the disassembly of the function at fn, from this executable; empty if
+// nm or objdump is missing or the symbol cannot be found
+inline std::string disassemble(const void* fn)
+{
+    // the tools run as children, so /proc/self would name them instead
+    char self[512];
+    ssize_t len = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    self[len > 0 ? len : 0] = 0;
+    std::string out;
+    if (len <= 0 || std::strchr(self, '\''))
+    {
+        return out;
+    }
+    // the executable's load address, to turn fn into a symbol address
+    uintptr_t base = 0;
+    if (FILE* maps = std::fopen("/proc/self/maps", "r"))
+    {
+        char line[512];
+        while (std::fgets(line, sizeof(line), maps))
+        {
+            unsigned long start, end, offset;
+            char path[512] = "";
+            if (std::sscanf(line, "%lx-%lx %*s %lx %*s %*s %511s", &start, &end, &offset, path) >= 3 &&
+                offset == 0 && std::strcmp(path, self) == 0)
+            {
+                base = start;
+                break;
+            }
+        }
+        std::fclose(maps);
+    }
+    uintptr_t address = (uintptr_t)fn;
+    std::string quoted = std::string("'") + self + "'";
+    FILE* nm = popen(("nm -S --defined-only " + quoted + " 2>/dev/null").c_str(), "r");
+    if (!nm)
+    {
+        return out;
+    }
+    // nm prints link-time addresses: offsets from base for a PIE, absolute otherwise
+    char line[1024];
+    unsigned long long symbol = 0, size = 0;
+    bool found = false;
+    while (std::fgets(line, sizeof(line), nm))
+    {
+        unsigned long long a, s;
+        if (std::sscanf(line, "%llx %llx", &a, &s) == 2 && (a == address - base || a == address))
+        {
+            symbol = a;
+            size = s;
+            found = true;
+        }
+    }
+    pclose(nm);
+    if (!found)
+    {
+        return out;
+    }
+    char range[128];
+    std::snprintf(range, sizeof(range), "--start-address=0x%llx --stop-address=0x%llx ", symbol, symbol + size);
+    std::string command = "objdump -d -C --no-show-raw-insn " + std::string(range) + quoted + " 2>/dev/null";
+    FILE* objdump = popen(command.c_str(), "r");
+    if (!objdump)
+    {
+        return out;
+    }
+    // keep the function's own lines, from its label on
+    bool body = false;
+    while (std::fgets(line, sizeof(line), objdump))
+    {
+        body = body || (std::strchr(line, '<') && std::strstr(line, ">:"));
+        if (body)
+        {
+            out += line;
+        }
+    }
+    pclose(objdump);
+    return out;
+}
+
+#endif
@@ -0,0 +1,118 @@
+// Compares roll-number lookup, update and delete through StudentRegistry's
+// hash index against the linear scan studentrecord.cpp used before.
+//   usage: registry_bench [records...]   (default 1000 100000 10000000)
+#include <cstdio>
+#include <vector>
+
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+// the old menu code: walk s[0..num) comparing roll numbers
+static int linear_find(const vector<Student>& s, int num, int roll_no)
+{
+    for (int i = 0; i < num; i++)
+    {
+        if (s[i].get_roll_no() == roll_no)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void run(size_t n)
+{
+    vector<int> rolls = make_rolls(n);
+    vector<Student> flat;
+    flat.reserve(n);
+    StudentRegistry registry;
+    for (size_t i = 0; i < n; i++)
+    {
+        flat.push_back(make_student(rolls[i], i));
+        registry.add(flat.back());
+    }
+
+    // the scan is O(n) per op, so give it a budget of ~10^8 record visits
+    size_t scan_ops = max<size_t>(20, 100000000 / n);
+    size_t hash_ops = 1000000;
+    vector<int> probe = make_rolls(n, 7);
+
+    printf("records=%zu\n", n);
+
+    {
+        Timer t;
+        long sum = 0;
+        for (size_t q = 0; q < scan_ops; q++)
+        {
+            sum += linear_find(flat, (int)n, probe[q % n]);
+        }
+        do_not_optimize(sum);
+        printf("  %-8s linear %12.1f ns/op", "find", t.seconds() / scan_ops * 1e9);
+    }
+    {
+        Timer t;
+        long sum = 0;
+        Student st;
+        for (size_t q = 0; q < hash_ops; q++)
+        {
+            sum += registry.get(probe[q % n], st);
+        }
+        do_not_optimize(sum);
+        printf("   hashed %10.1f ns/op\n", t.seconds() / hash_ops * 1e9);
+    }
+
+    {
+        Timer t;
+        for (size_t q = 0; q < scan_ops; q++)
+        {
+            int i = linear_find(flat, (int)n, probe[q % n]);
+            flat[i] = make_student(probe[q % n], q);
+        }
+        printf("  %-8s linear %12.1f ns/op", "update", t.seconds() / scan_ops * 1e9);
+    }
+    {
+        Timer t;
+        for (size_t q = 0; q < hash_ops; q++)
+        {
+            registry.update(make_student(probe[q % n], q));
+        }
+        printf("   hashed %10.1f ns/op\n", t.seconds() / hash_ops * 1e9);
+    }
+
+    // delete shifts the tail down, as case 5 did
+    size_t del_ops = min(scan_ops, n / 2);
+    {
+        Timer t;
+        int num = (int)n;
+        for (size_t q = 0; q < del_ops; q++)
+        {
+            int i = linear_find(flat, num, probe[q]);
+            for (int j = i; j < num - 1; j++)
+            {
+                flat[j] = flat[j + 1];
+            }
+            num--;
+        }
+        printf("  %-8s linear %12.1f ns/op", "delete", t.seconds() / del_ops * 1e9);
+    }
+    {
+        size_t ops = n / 2;
+        Timer t;
+        for (size_t q = 0; q < ops; q++)
+        {
+            registry.remove(probe[q]);
+        }
+        printf("   hashed %10.1f ns/op\n", t.seconds() / ops * 1e9);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    for (size_t n : sizes_from_args(argc, argv, {1000, 100000, 10000000}))
+    {
+        run(n);
+    }
+    return 0;
+}
@@ -0,0 +1,490 @@
+// Load generator for the registry server (registryserver.h, studentrecord
+// --serve). Each connection runs on its own thread and keeps a pipeline
+// of requests in flight: 75% get, 10% update, 5% add, 5% delete of a
+// student it added, 5% top 10. Reports throughput and the p50/p99/p999
+// latency from sending a request to reading its reply, first one request
+// at a time and then at the given pipeline depth.
+//
+// Without a socket path it starts a server in this process on a
+// temporary socket and fills it with the given number of students. It
+// also checks replies to a fixed sequence of requests, including bad ones,
+// that a client which half-closes behind a deep pipeline gets every reply,
+// that the server neither spins nor stalls at the descriptor limit, and
+// that every reply came back in order.
+// Given a socket path, it drives that server instead and assumes the
+// students have roll numbers 1 to students.
+//   usage: server_load [requests] [connections] [depth] [students] [socket]   (default 1000000 4 32 100000)
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../latency.h"
+#include "../registryserver.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static int connect_to(const string& path)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (const sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool send_all(int fd, const string& data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t w = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (w <= 0)
+        {
+            return false;
+        }
+        sent += (size_t)w;
+    }
+    return true;
+}
+
+// reads until in holds at least one whole reply; false on a closed socket
+static bool read_more(int fd, string& in)
+{
+    char block[65536];
+    for (;;)
+    {
+        ssize_t got = read(fd, block, sizeof(block));
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got <= 0)
+        {
+            return false;
+        }
+        in.append(block, (size_t)got);
+        ServerReply reply;
+        if (server_parse_reply(in, reply))
+        {
+            return true;
+        }
+    }
+}
+
+// one request, one reply
+class Probe
+{
+public:
+    explicit Probe(int fd) : fd(fd) {}
+
+    bool ask(const string& request, ServerReply& reply)
+    {
+        in.erase(0, used);
+        used = 0;
+        if (!send_all(fd, request) || !read_more(fd, in))
+        {
+            return false;
+        }
+        used = server_parse_reply(in, reply);
+        return true;
+    }
+
+private:
+    int fd;
+    string in;
+    size_t used = 0;
+};
+
+// the replies to a fixed sequence of requests
+static bool check_replies(const string& path)
+{
+    int fd = connect_to(path);
+    if (fd < 0)
+    {
+        return false;
+    }
+    Probe probe(fd);
+    ServerReply reply;
+    string request;
+    bool ok = true;
+    auto expect = [&](ServerStatus status, uint32_t tag)
+    {
+        bool ok = probe.ask(request, reply) && reply.status == status && reply.tag == tag;
+        request.clear();
+        return ok;
+    };
+    const int roll_no = 2000000000;
+    int marks[4] = {91, 82, 73, 64}, got_marks[4], got_roll = 0;
+    string_view got_name;
+
+    server_request(request, ServerOp::Add, 1, roll_no, marks, "Probe, Student");
+    ok &= expect(ServerStatus::Ok, 1);
+    server_request(request, ServerOp::Add, 2, roll_no, marks, "Again");
+    ok &= expect(ServerStatus::Exists, 2);
+    server_request(request, ServerOp::Get, 3, roll_no);
+    ok &= expect(ServerStatus::Ok, 3) && reply.record(got_roll, got_marks, got_name) && got_roll == roll_no &&
+          memcmp(got_marks, marks, sizeof(marks)) == 0 && got_name == "Probe, Student";
+    marks[0] = 100;
+    server_request(request, ServerOp::Update, 4, roll_no, marks, "Renamed");
+    ok &= expect(ServerStatus::Ok, 4);
+    server_request(request, ServerOp::Get, 5, roll_no);
+    ok &= expect(ServerStatus::Ok, 5) && reply.record(got_roll, got_marks, got_name) && got_marks[0] == 100 &&
+          got_name == "Renamed";
+    server_top_request(request, 6, 3);
+    ok &= expect(ServerStatus::Ok, 6);
+    int previous = 401;
+    size_t entries = reply.top([&](int, int total)
+    {
+        ok &= total <= previous;
+        previous = total;
+    });
+    ok &= entries >= 1;
+    server_request(request, ServerOp::Delete, 7, roll_no);
+    ok &= expect(ServerStatus::Ok, 7);
+    server_request(request, ServerOp::Get, 8, roll_no);
+    ok &= expect(ServerStatus::NotFound, 8);
+    server_request(request, ServerOp::Delete, 9, roll_no);
+    ok &= expect(ServerStatus::NotFound, 9);
+    server_request(request, (ServerOp)99, 10, roll_no);
+    ok &= expect(ServerStatus::BadRequest, 10);
+    server_request(request, ServerOp::Get, 11, roll_no);
+    request.pop_back();
+    request[0]--;  // a payload one byte short
+    ok &= expect(ServerStatus::BadRequest, 11);
+    close(fd);
+    return ok;
+}
+
+// a client that pipelines more requests than max_pending_out holds
+// replies for and shuts down its write side straight away must still get
+// every reply, in order, before the server closes
+static bool check_half_close(const string& path)
+{
+    int fd = connect_to(path);
+    if (fd < 0)
+    {
+        return false;
+    }
+    const uint32_t tops = 600;  // up to 32 KB of reply each
+    string out;
+    for (uint32_t tag = 0; tag < tops; tag++)
+    {
+        server_top_request(out, tag, server_max_top);
+    }
+    string in;
+    thread reader([&]
+    {
+        char block[65536];
+        ssize_t got;
+        while ((got = read(fd, block, sizeof(block))) > 0 || (got < 0 && errno == EINTR))
+        {
+            in.append(block, (size_t)max<ssize_t>(got, 0));
+        }
+    });
+    bool ok = send_all(fd, out) && shutdown(fd, SHUT_WR) == 0;
+    reader.join();
+    close(fd);
+    size_t pos = 0, used;
+    uint32_t next = 0;
+    ServerReply reply;
+    while ((used = server_parse_reply(string_view(in).substr(pos), reply)) != 0)
+    {
+        ok = ok && reply.status == ServerStatus::Ok && reply.tag == next;
+        next++;
+        pos += used;
+    }
+    return ok && next == tops && pos == in.size();
+}
+
+// at the descriptor limit the server must turn waiting clients away
+// (each sees end of file) without spinning, and serve again once
+// descriptors are free
+static bool check_fd_limit(const string& path, thread& server)
+{
+    vector<int> clients;
+    for (int i = 0; i < 8; i++)
+    {
+        clients.push_back(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    }
+    rlimit saved;
+    getrlimit(RLIMIT_NOFILE, &saved);
+    rlimit low = saved;
+    low.rlim_cur = (rlim_t)*max_element(clients.begin(), clients.end()) + 1;
+    setrlimit(RLIMIT_NOFILE, &low);
+    vector<int> fillers;
+    for (int fd; (fd = open("/dev/null", O_RDONLY | O_CLOEXEC)) >= 0;)
+    {
+        fillers.push_back(fd);
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    bool ok = true;
+    for (int fd : clients)
+    {
+        ok &= connect(fd, (const sockaddr*)&addr, sizeof(addr)) == 0;
+    }
+    for (int fd : clients)
+    {
+        pollfd p{fd, POLLIN, 0};
+        char byte;
+        ok &= poll(&p, 1, 2000) == 1 && read(fd, &byte, 1) == 0;
+    }
+    clockid_t clock;
+    timespec before{}, after{};
+    pthread_getcpuclockid(server.native_handle(), &clock);
+    clock_gettime(clock, &before);
+    this_thread::sleep_for(chrono::milliseconds(500));
+    clock_gettime(clock, &after);
+    double busy = (after.tv_sec - before.tv_sec) + (after.tv_nsec - before.tv_nsec) / 1e9;
+    printf("server CPU while idle at the descriptor limit: %.0f ms in 500 ms\n", busy * 1e3);
+    ok &= busy < 0.1;
+
+    for (int fd : fillers)
+    {
+        close(fd);
+    }
+    for (int fd : clients)
+    {
+        close(fd);
+    }
+    setrlimit(RLIMIT_NOFILE, &saved);
+    int fd = connect_to(path);
+    Probe probe(fd);
+    ServerReply reply;
+    string request;
+    server_request(request, ServerOp::Get, 1, 1);
+    ok &= fd >= 0 && probe.ask(request, reply) && reply.status == ServerStatus::Ok;
+    close(fd);
+    return ok;
+}
+
+struct ConnectionResult
+{
+    LatencyHistogram latency;
+    uint64_t replies = 0;
+    bool in_order = true;
+};
+
+// keeps depth requests in flight until requests have been answered
+static void drive(const string& path, size_t requests, size_t depth, size_t students, uint64_t seed,
+                  ConnectionResult& result)
+{
+    int fd = connect_to(path);
+    if (fd < 0)
+    {
+        result.in_order = false;
+        return;
+    }
+    mt19937_64 rng(seed);
+    // roll numbers this connection adds, above any in the roster
+    int next_own = 1000000000 + (int)(seed % 1000) * 1000000;
+    vector<int> own;
+    deque<pair<uint32_t, uint64_t>> in_flight;  // tag, time queued in ns
+    uint32_t next_tag = 0;
+    size_t sent = 0;
+    string out, in;
+    auto queue_request = [&]
+    {
+        unsigned kind = (unsigned)(rng() % 100);
+        int marks[4] = {(int)(rng() % 101), (int)(rng() % 101), (int)(rng() % 101), (int)(rng() % 101)};
+        int roll_no = (int)(rng() % students) + 1;
+        if (kind < 75)
+        {
+            server_request(out, ServerOp::Get, next_tag, roll_no);
+        }
+        else if (kind < 85)
+        {
+            server_request(out, ServerOp::Update, next_tag, roll_no, marks, "S" + to_string(roll_no));
+        }
+        else if (kind < 90 || (kind < 95 && own.empty()))
+        {
+            own.push_back(next_own);
+            server_request(out, ServerOp::Add, next_tag, next_own, marks, "L" + to_string(next_own));
+            next_own++;
+        }
+        else if (kind < 95)
+        {
+            server_request(out, ServerOp::Delete, next_tag, own.back());
+            own.pop_back();
+        }
+        else
+        {
+            server_top_request(out, next_tag, 10);
+        }
+        in_flight.emplace_back(next_tag++, latency_steady_ns());
+        sent++;
+    };
+
+    while (result.replies < requests)
+    {
+        // top the pipeline up and send the whole batch at once
+        while (sent < requests && in_flight.size() < depth)
+        {
+            queue_request();
+        }
+        if ((!out.empty() && !send_all(fd, out)) || !read_more(fd, in))
+        {
+            result.in_order = false;
+            break;
+        }
+        out.clear();
+        uint64_t now = latency_steady_ns();
+        size_t pos = 0, used;
+        ServerReply reply;
+        while ((used = server_parse_reply(string_view(in).substr(pos), reply)) != 0)
+        {
+            if (in_flight.empty() || reply.tag != in_flight.front().first)
+            {
+                result.in_order = false;
+            }
+            if (!in_flight.empty())
+            {
+                result.latency.record(now - in_flight.front().second);
+                in_flight.pop_front();
+            }
+            result.replies++;
+            pos += used;
+        }
+        in.erase(0, pos);
+    }
+    close(fd);
+}
+
+int main(int argc, char** argv)
+{
+    size_t requests = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t connections = argc > 2 ? strtoull(argv[2], nullptr, 10) : 4;
+    size_t depth = argc > 3 ? strtoull(argv[3], nullptr, 10) : 32;
+    size_t students = argc > 4 ? strtoull(argv[4], nullptr, 10) : 100000;
+    string path = argc > 5 ? argv[5] : "";
+    connections = max<size_t>(connections, 1);
+    depth = max<size_t>(depth, 1);
+    students = max<size_t>(students, 1);
+    bool ok = true;
+
+    // an in-process server unless one was named
+    StudentRegistry registry;
+    atomic<bool> stop{false};
+    thread server_thread;
+    char dir[] = "/tmp/server_loadXXXXXX";
+    if (path.empty())
+    {
+        if (!mkdtemp(dir))
+        {
+            perror("mkdtemp");
+            return 1;
+        }
+        path = string(dir) + "/registry.sock";
+        registry.reserve(students);
+        for (size_t i = 1; i <= students; i++)
+        {
+            registry.add(make_student((int)i, i));
+        }
+        string error;
+        auto server = make_shared<RegistryServer>(registry);
+        if (!server->listen(path, error))
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        server_thread = thread([server, &stop]
+        {
+            string error;
+            if (!server->run(stop, error))
+            {
+                fprintf(stderr, "%s\n", error.c_str());
+            }
+        });
+        if (!check_replies(path))
+        {
+            printf("MISMATCH in the replies to the check sequence\n");
+            ok = false;
+        }
+        if (!check_half_close(path))
+        {
+            printf("MISMATCH: replies lost after the client shut down its write side\n");
+            ok = false;
+        }
+        if (!check_fd_limit(path, server_thread))
+        {
+            printf("MISMATCH at the descriptor limit\n");
+            ok = false;
+        }
+    }
+
+    printf("%zu requests over %zu connections, %zu students, socket %s\n", requests, connections, students,
+           path.c_str());
+    printf("%6s %12s %10s %10s %10s %10s\n", "depth", "requests/s", "p50 us", "p99 us", "p999 us", "max us");
+    vector<size_t> depths = {1};
+    if (depth > 1)
+    {
+        depths.push_back(depth);
+    }
+    for (size_t d : depths)
+    {
+        vector<ConnectionResult> results(connections);
+        vector<thread> threads;
+        Timer t;
+        for (size_t c = 0; c < connections; c++)
+        {
+            size_t share = requests / connections + (c < requests % connections);
+            threads.emplace_back(drive, path, share, d, students, 1000 * d + c, ref(results[c]));
+        }
+        for (thread& th : threads)
+        {
+            th.join();
+        }
+        double seconds = t.seconds();
+        LatencyHistogram all;
+        uint64_t replies = 0;
+        for (const ConnectionResult& r : results)
+        {
+            all.merge(r.latency);
+            replies += r.replies;
+            if (!r.in_order)
+            {
+                printf("MISMATCH: replies missing or out of order at depth %zu\n", d);
+                ok = false;
+            }
+        }
+        printf("%6zu %12.0f %10.2f %10.2f %10.2f %10.2f\n", d, replies / seconds, all.percentile(50) / 1e3,
+               all.percentile(99) / 1e3, all.percentile(99.9) / 1e3, all.max() / 1e3);
+    }
+
+    if (server_thread.joinable())
+    {
+        stop.store(true);
+        server_thread.join();
+        rmdir(dir);
+    }
+    printf(ok ? "results match\n" : "results differ\n");
+    return ok ? 0 : 1;
+}
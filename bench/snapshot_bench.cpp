@@ -0,0 +1,130 @@
+// Compares loading a roster from a binary snapshot against parsing the
+// same roster from a whitespace-separated text file with iostreams.
+// Reports the O(1) map/attach step and the decode-on-first-use step
+// separately, then checks that headers whose offsets or counts would
+// overflow or point past the file are rejected.
+//   usage: snapshot_bench [students]   (default 1000000)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#include "../studentregistry.h"
+#include "benchutil.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    const string snap_path = "snapshot_bench.snap";
+    const string text_path = "snapshot_bench.txt";
+
+    {
+        StudentRegistry registry;
+        registry.reserve(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            registry.add(make_student((int)i + 1, i));
+        }
+        string error;
+        Timer t;
+        if (!registry.save(snap_path, error))
+        {
+            printf("save failed: %s\n", error.c_str());
+            return 1;
+        }
+        printf("students=%zu  save %.1f ms\n", n, t.seconds() * 1e3);
+
+        ofstream text(text_path);
+        registry.for_each([&](const Student& st)
+        {
+            text << st.get_name() << ' ' << st.get_roll_no();
+            for (int k = 0; k < 4; k++)
+            {
+                text << ' ' << st.get_marks(k);
+            }
+            text << '\n';
+        });
+    }
+
+    {
+        Timer t;
+        StudentRegistry registry;
+        ifstream text(text_path);
+        string name;
+        int roll_no, marks[4];
+        while (text >> name >> roll_no >> marks[0] >> marks[1] >> marks[2] >> marks[3])
+        {
+            registry.add(Student(name, roll_no, marks));
+        }
+        printf("  text parse          %10.1f ms  (%zu students)\n", t.seconds() * 1e3, registry.size());
+    }
+
+    {
+        Timer t;
+        shared_ptr<SnapshotView> view = make_shared<SnapshotView>();
+        string error;
+        if (!view->open(snap_path, error))
+        {
+            printf("open failed: %s\n", error.c_str());
+            return 1;
+        }
+        StudentRegistry registry;
+        registry.attach(view);
+        double attach_s = t.seconds();
+
+        Timer lazy;
+        Student st;
+        view->get(n / 2, st);
+        double one_s = lazy.seconds();
+
+        Timer first;
+        registry.contains(1);
+        double first_s = first.seconds();
+        printf("  snapshot attach     %10.3f ms\n", attach_s * 1e3);
+        printf("  one lazy record     %10.3f ms\n", one_s * 1e3);
+        printf("  decode on first use %10.1f ms  (%zu students)\n", first_s * 1e3, registry.size());
+        printf("  snapshot total      %10.1f ms\n", (attach_s + first_s) * 1e3);
+    }
+
+    // a valid header with one bad field each, over a few records' worth
+    // of file; none may open
+    bool ok = true;
+    const uint64_t bad[][2] = {
+        {~0ull - 31, 1},        // records_offset + count * 32 wraps to 0
+        {64, 1ull << 59},       // count * 32 wraps to 0
+        {4096, 1},              // records past the end
+        {64, 5},                // one record too many
+        {65, 1},                // misaligned records
+    };
+    for (const auto& b : bad)
+    {
+        char file[64 + 4 * sizeof(SnapshotRecord)] = {};
+        SnapshotHeader h{};
+        memcpy(h.magic, snapshot_magic, sizeof(h.magic));
+        h.version = snapshot_version;
+        h.record_size = sizeof(SnapshotRecord);
+        h.records_offset = b[0];
+        h.count = b[1];
+        h.names_offset = sizeof(file);
+        memcpy(file, &h, sizeof(h));
+        FILE* f = fopen(snap_path.c_str(), "wb");
+        fwrite(file, 1, sizeof(file), f);
+        fclose(f);
+        SnapshotView view;
+        string error;
+        if (view.open(snap_path, error))
+        {
+            printf("MISMATCH: opened a header with records_offset %llu, count %llu\n", (unsigned long long)b[0],
+                   (unsigned long long)b[1]);
+            ok = false;
+        }
+    }
+
+    remove(snap_path.c_str());
+    remove(text_path.c_str());
+    printf("%s\n", ok ? "results match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
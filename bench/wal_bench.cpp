@@ -0,0 +1,127 @@
+// Mutations per second through the write-ahead log with an fsync per
+// mutation against group commit, single-threaded and with several threads
+// that each wait for their own change to be durable. Then replays a log
+// of 10^6 entries into an empty registry. The log is written to the
+// current directory, so run it on the disk you care about.
+//   usage: wal_bench [replay entries] [threads]   (default 1000000 4)
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../studentregistry.h"
+#include "../wal.h"
+#include "benchutil.h"
+
+using namespace std;
+
+static const char* wal_path = "wal_bench.wal";
+
+static bool open_log(WriteAheadLog& wal, unsigned commit_ms, size_t commit_bytes)
+{
+    WalOptions options;
+    options.commit_ms = commit_ms;
+    options.commit_bytes = commit_bytes;
+    string error;
+    remove(wal_path);
+    if (!wal.open(wal_path, options, [](const WalEntry&) {}, error))
+    {
+        printf("open failed: %s\n", error.c_str());
+        return false;
+    }
+    return true;
+}
+
+// n appends from one thread, then one sync
+static double single(unsigned commit_ms, size_t commit_bytes, size_t n)
+{
+    WriteAheadLog wal;
+    if (!open_log(wal, commit_ms, commit_bytes))
+    {
+        return 0;
+    }
+    int marks[4] = {50, 60, 70, 80};
+    Timer t;
+    for (size_t i = 0; i < n; i++)
+    {
+        wal.append(WalOp::Update, (int)(i % 1000) + 1, marks, "Student of the class");
+    }
+    wal.sync();
+    return n / t.seconds();
+}
+
+// threads each append and wait until the entry is durable before the next
+static double durable(unsigned commit_ms, size_t commit_bytes, unsigned threads, size_t per_thread)
+{
+    WriteAheadLog wal;
+    if (!open_log(wal, commit_ms, commit_bytes))
+    {
+        return 0;
+    }
+    vector<thread> pool;
+    Timer t;
+    for (unsigned k = 0; k < threads; k++)
+    {
+        pool.emplace_back([&, k]
+        {
+            int marks[4] = {50, 60, 70, 80};
+            for (size_t i = 0; i < per_thread; i++)
+            {
+                wal.wait_durable(wal.append(WalOp::Update, (int)(k * per_thread + i), marks, "Student"));
+            }
+        });
+    }
+    for (thread& th : pool)
+    {
+        th.join();
+    }
+    return threads * per_thread / t.seconds();
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    unsigned threads = argc > 2 ? (unsigned)atoi(argv[2]) : 4;
+
+    printf("%-36s %14s\n", "mode", "mutations/s");
+    printf("%-36s %14.0f\n", "fsync per mutation", single(0, 0, 2000));
+    printf("%-36s %14.0f\n", "group commit 5 ms / 64 KB", single(5, 64 * 1024, 200000));
+    printf("%-36s %14.0f\n", "group commit 64 KB, no timer", single(0, 64 * 1024, 200000));
+    char label[64];
+    snprintf(label, sizeof(label), "%u threads, fsync per mutation", threads);
+    printf("%-36s %14.0f\n", label, durable(0, 0, threads, 500));
+    snprintf(label, sizeof(label), "%u threads, group commit 1 ms", threads);
+    printf("%-36s %14.0f\n", label, durable(1, 0, threads, 500));
+
+    // replay
+    {
+        WriteAheadLog wal;
+        if (!open_log(wal, 5, 1 << 20))
+        {
+            return 1;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            Student st = make_student((int)(i % (n / 2 + 1)) + 1, i);
+            int marks[4] = {st.get_marks(0), st.get_marks(1), st.get_marks(2), st.get_marks(3)};
+            WalOp op = i % 10 == 9 ? WalOp::Delete : i < n / 2 ? WalOp::Add : WalOp::Update;
+            wal.append(op, st.get_roll_no(), marks, st.get_name());
+        }
+    }
+    {
+        WriteAheadLog wal;
+        StudentRegistry registry;
+        registry.defer_indexes();
+        string error;
+        Timer t;
+        if (!wal.open(wal_path, WalOptions(), [&](const WalEntry& e) { apply_wal_entry(registry, e); }, error))
+        {
+            printf("replay failed: %s\n", error.c_str());
+            return 1;
+        }
+        printf("replayed %zu entries in %.1f ms, %zu students\n", wal.replayed_entries(),
+               t.seconds() * 1e3, registry.size());
+    }
+    remove(wal_path);
+    return 0;
+}
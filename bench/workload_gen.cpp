@@ -0,0 +1,79 @@
+// Writes a studentrecord --script workload to stdout: adds the given number
+// of students, then runs a mix of operations over them, roughly what a
+// registry sees in use: 40% show (find), 25% update, 15% add, 10% delete,
+// 5% name-prefix search and 5% top-10, with a full listing (display)
+// after every third of the operations and class statistics at the end.
+// Used as the PGO training run and as the benchmark the optimized builds
+// are compared on (scripts/pgo_pipeline.sh), with different seeds.
+//   usage: workload_gen [students] [operations] [seed]   (default 100000 300000 1)
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+static void add_line(int roll_no, mt19937_64& rng)
+{
+    printf("add S%d,%d,%d,%d,%d,%d\n", roll_no, roll_no, (int)(rng() % 101), (int)(rng() % 101),
+           (int)(rng() % 101), (int)(rng() % 101));
+}
+
+int main(int argc, char** argv)
+{
+    size_t students = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    size_t operations = argc > 2 ? strtoull(argv[2], nullptr, 10) : 300000;
+    uint64_t seed = argc > 3 ? strtoull(argv[3], nullptr, 10) : 1;
+    mt19937_64 rng(seed);
+
+    vector<int> live;
+    int next_roll = 1;
+    for (size_t i = 0; i < students; i++)
+    {
+        add_line(next_roll, rng);
+        live.push_back(next_roll++);
+    }
+    size_t listing = operations / 3 ? operations / 3 : 1;
+    for (size_t op = 0; op < operations; op++)
+    {
+        if (op > 0 && op % listing == 0)
+        {
+            printf("list\n");
+        }
+        unsigned kind = (unsigned)(rng() % 100);
+        if (live.empty() || (kind >= 40 && kind < 55))
+        {
+            add_line(next_roll, rng);
+            live.push_back(next_roll++);
+            continue;
+        }
+        size_t pick = rng() % live.size();
+        int roll_no = live[pick];
+        if (kind < 40)
+        {
+            printf("show %d\n", roll_no);
+        }
+        else if (kind < 80)
+        {
+            // one update in ten also renames the student
+            printf("update %s%d,%d,%d,%d,%d,%d\n", rng() % 10 ? "S" : "R", roll_no, roll_no, (int)(rng() % 101),
+                   (int)(rng() % 101), (int)(rng() % 101), (int)(rng() % 101));
+        }
+        else if (kind < 90)
+        {
+            printf("delete %d\n", roll_no);
+            live[pick] = live.back();
+            live.pop_back();
+        }
+        else if (kind < 95)
+        {
+            printf("search S%d\n", roll_no);
+        }
+        else
+        {
+            printf("top 10\n");
+        }
+    }
+    printf("stats\n");
+    return 0;
+}
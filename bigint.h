@@ -0,0 +1,654 @@
+// Arbitrary-precision integers.
+//
+// The demo programs do their arithmetic in int, which silently wraps
+// (n * m in operator.cpp, Fibonacci terms from F(47)). A BigInt is a sign
+// and a magnitude of 64-bit limbs, least significant first, with no
+// leading zero limbs, so zero is an empty magnitude and is never negative.
+//
+// Multiplication is schoolbook below karatsuba_cutoff limbs and Karatsuba
+// above it. Division is Knuth's algorithm D and truncates toward zero like
+// int. Decimal output splits the number around powers 10^(19 * 2^i) and
+// converts the halves recursively, so most of the work is a few large
+// divisions rather than one pass per 19 digits.
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class BigInt
+{
+public:
+    typedef std::vector<uint64_t> Limbs;
+
+    // limbs at which multiplication switches to Karatsuba; tuned with
+    // bench/bigint_bench, and SIZE_MAX gives schoolbook only
+    static inline size_t karatsuba_cutoff = 48;
+
+    BigInt() {}
+
+    template <class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+    BigInt(T v)
+    {
+        uint64_t m = (uint64_t)v;
+        if (std::is_signed<T>::value && (long long)v < 0)
+        {
+            negative = true;
+            m = 0 - m;
+        }
+        if (m)
+        {
+            limbs.push_back(m);
+        }
+    }
+
+    // optional '-' or '+' then decimal digits; false if s is anything else
+    static bool parse(std::string_view s, BigInt& out)
+    {
+        bool minus = !s.empty() && s[0] == '-';
+        if (!s.empty() && (s[0] == '-' || s[0] == '+'))
+        {
+            s.remove_prefix(1);
+        }
+        if (s.empty())
+        {
+            return false;
+        }
+        BigInt r;
+        // 19 digits at a time: r = r * 10^len + chunk
+        size_t first = s.size() % chunk_digits ? s.size() % chunk_digits : chunk_digits;
+        for (size_t at = 0, len = first; at < s.size(); at += len, len = chunk_digits)
+        {
+            uint64_t chunk = 0, scale = 1;
+            for (size_t i = at; i < at + len; i++)
+            {
+                if (s[i] < '0' || s[i] > '9')
+                {
+                    return false;
+                }
+                chunk = chunk * 10 + (uint64_t)(s[i] - '0');
+                scale *= 10;
+            }
+            mul_add_small(r.limbs, scale, chunk);
+        }
+        r.negative = minus && !r.is_zero();
+        out = std::move(r);
+        return true;
+    }
+
+    bool is_zero() const
+    {
+        return limbs.empty();
+    }
+
+    bool is_negative() const
+    {
+        return negative;
+    }
+
+    // number of 64-bit limbs in the magnitude
+    size_t size() const
+    {
+        return limbs.size();
+    }
+
+    size_t bit_length() const
+    {
+        return limbs.empty() ? 0 : 64 * limbs.size() - __builtin_clzll(limbs.back());
+    }
+
+    // the magnitude modulo 2^64
+    uint64_t low64() const
+    {
+        return limbs.empty() ? 0 : limbs[0];
+    }
+
+    const Limbs& magnitude() const
+    {
+        return limbs;
+    }
+
+    BigInt operator-() const
+    {
+        BigInt r = *this;
+        r.negative = !r.negative && !r.is_zero();
+        return r;
+    }
+
+    BigInt& operator+=(const BigInt& b)
+    {
+        add_signed(b, b.negative);
+        return *this;
+    }
+
+    BigInt& operator-=(const BigInt& b)
+    {
+        add_signed(b, !b.negative);
+        return *this;
+    }
+
+    BigInt& operator*=(const BigInt& b)
+    {
+        *this = *this * b;
+        return *this;
+    }
+
+    BigInt& operator/=(const BigInt& b)
+    {
+        *this = *this / b;
+        return *this;
+    }
+
+    BigInt& operator%=(const BigInt& b)
+    {
+        *this = *this % b;
+        return *this;
+    }
+
+    // q = a / b and r = a % b, truncating like int; false if b is zero
+    static bool divmod(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r)
+    {
+        if (b.is_zero())
+        {
+            return false;
+        }
+        Limbs qm, rm;
+        divmod_mag(a.limbs, b.limbs, qm, rm);
+        q.limbs.swap(qm);
+        q.negative = (a.negative != b.negative) && !q.is_zero();
+        r.limbs.swap(rm);
+        r.negative = a.negative && !r.is_zero();
+        return true;
+    }
+
+    friend BigInt operator+(BigInt a, const BigInt& b)
+    {
+        return a += b;
+    }
+
+    friend BigInt operator-(BigInt a, const BigInt& b)
+    {
+        return a -= b;
+    }
+
+    friend BigInt operator*(const BigInt& a, const BigInt& b)
+    {
+        BigInt r;
+        r.limbs = mul_mag(a.limbs, b.limbs);
+        r.negative = (a.negative != b.negative) && !r.is_zero();
+        return r;
+    }
+
+    // b must not be zero; use divmod to check
+    friend BigInt operator/(const BigInt& a, const BigInt& b)
+    {
+        BigInt q, r;
+        divmod(a, b, q, r);
+        return q;
+    }
+
+    friend BigInt operator%(const BigInt& a, const BigInt& b)
+    {
+        BigInt q, r;
+        divmod(a, b, q, r);
+        return r;
+    }
+
+    friend bool operator==(const BigInt& a, const BigInt& b)
+    {
+        return a.negative == b.negative && a.limbs == b.limbs;
+    }
+
+    friend bool operator!=(const BigInt& a, const BigInt& b)
+    {
+        return !(a == b);
+    }
+
+    friend bool operator<(const BigInt& a, const BigInt& b)
+    {
+        if (a.negative != b.negative)
+        {
+            return a.negative;
+        }
+        int c = cmp_mag(a.limbs, b.limbs);
+        return a.negative ? c > 0 : c < 0;
+    }
+
+    friend bool operator>(const BigInt& a, const BigInt& b)
+    {
+        return b < a;
+    }
+
+    friend bool operator<=(const BigInt& a, const BigInt& b)
+    {
+        return !(b < a);
+    }
+
+    friend bool operator>=(const BigInt& a, const BigInt& b)
+    {
+        return !(a < b);
+    }
+
+    // decimal, with a leading '-' when negative
+    std::string to_string() const
+    {
+        if (limbs.empty())
+        {
+            return "0";
+        }
+        // powers[i] = 10^(19 * 2^i), up to about half the number's size
+        std::vector<Limbs> powers(1, Limbs(1, chunk_base));
+        while (powers.back().size() * 2 <= limbs.size())
+        {
+            powers.push_back(mul_mag(powers.back(), powers.back()));
+        }
+        std::string s = negative ? "-" : "";
+        s.reserve(limbs.size() * 20);
+        append_decimal(limbs, powers, 0, s);
+        return s;
+    }
+
+private:
+    Limbs limbs;
+    bool negative = false;
+
+    static constexpr uint64_t chunk_base = 10000000000000000000ull;
+    static constexpr size_t chunk_digits = 19;
+    // below this many limbs, decimal output divides by 10^19 directly
+    static constexpr size_t decimal_cutoff = 32;
+
+    static void trim(Limbs& m)
+    {
+        while (!m.empty() && m.back() == 0)
+        {
+            m.pop_back();
+        }
+    }
+
+    static int cmp_mag(const Limbs& a, const Limbs& b)
+    {
+        if (a.size() != b.size())
+        {
+            return a.size() < b.size() ? -1 : 1;
+        }
+        for (size_t i = a.size(); i-- > 0;)
+        {
+            if (a[i] != b[i])
+            {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    // a += b
+    static void add_mag(Limbs& a, const Limbs& b)
+    {
+        if (a.size() < b.size())
+        {
+            a.resize(b.size(), 0);
+        }
+        unsigned char carry = 0;
+        size_t i = 0;
+        for (; i < b.size(); i++)
+        {
+            unsigned long long s;
+            carry = __builtin_add_overflow(a[i], b[i], &s) | __builtin_add_overflow(s, (unsigned long long)carry, &s);
+            a[i] = s;
+        }
+        for (; carry && i < a.size(); i++)
+        {
+            carry = ++a[i] == 0;
+        }
+        if (carry)
+        {
+            a.push_back(1);
+        }
+    }
+
+    // a -= b, where |a| >= |b|
+    static void sub_mag(Limbs& a, const Limbs& b)
+    {
+        unsigned char borrow = 0;
+        size_t i = 0;
+        for (; i < b.size(); i++)
+        {
+            unsigned long long d;
+            borrow = __builtin_sub_overflow(a[i], b[i], &d) | __builtin_sub_overflow(d, (unsigned long long)borrow, &d);
+            a[i] = d;
+        }
+        for (; borrow && i < a.size(); i++)
+        {
+            borrow = a[i]-- == 0;
+        }
+        trim(a);
+    }
+
+    // *this += (negate_b ? -|b| : |b|)
+    void add_signed(const BigInt& b, bool negate_b)
+    {
+        if (negative == negate_b)
+        {
+            add_mag(limbs, b.limbs);
+        }
+        else if (cmp_mag(limbs, b.limbs) >= 0)
+        {
+            sub_mag(limbs, b.limbs);
+        }
+        else
+        {
+            Limbs r = b.limbs;
+            sub_mag(r, limbs);
+            limbs.swap(r);
+            negative = negate_b;
+        }
+        if (limbs.empty())
+        {
+            negative = false;
+        }
+    }
+
+    static Limbs mul_mag(const Limbs& a, const Limbs& b)
+    {
+        if (a.empty() || b.empty())
+        {
+            return Limbs();
+        }
+        Limbs r(a.size() + b.size());
+        mul_into(a.data(), a.size(), b.data(), b.size(), r.data());
+        trim(r);
+        return r;
+    }
+
+    // n less any zero limbs at the top of p[0, n)
+    static size_t used(const uint64_t* p, size_t n)
+    {
+        while (n && p[n - 1] == 0)
+        {
+            n--;
+        }
+        return n;
+    }
+
+    // r[0, nr) += x[0, nx), nr >= nx; returns the carry out of r
+    static unsigned char add_into(uint64_t* r, size_t nr, const uint64_t* x, size_t nx)
+    {
+        unsigned char carry = 0;
+        size_t i = 0;
+        for (; i < nx; i++)
+        {
+            unsigned long long s;
+            carry = __builtin_add_overflow(r[i], x[i], &s) | __builtin_add_overflow(s, (unsigned long long)carry, &s);
+            r[i] = s;
+        }
+        for (; carry && i < nr; i++)
+        {
+            carry = ++r[i] == 0;
+        }
+        return carry;
+    }
+
+    // r[0, nr) -= x[0, nx), nr >= nx and the result is not negative
+    static void sub_into(uint64_t* r, size_t nr, const uint64_t* x, size_t nx)
+    {
+        unsigned char borrow = 0;
+        size_t i = 0;
+        for (; i < nx; i++)
+        {
+            unsigned long long d;
+            borrow = __builtin_sub_overflow(r[i], x[i], &d) | __builtin_sub_overflow(d, (unsigned long long)borrow, &d);
+            r[i] = d;
+        }
+        for (; borrow && i < nr; i++)
+        {
+            borrow = r[i]-- == 0;
+        }
+    }
+
+    // r[0, na + nb) = a * b; r must not overlap a or b
+    static void mul_into(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* r)
+    {
+        if (na < nb)
+        {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        // (Karatsuba needs 4 limbs for its half sums to be smaller)
+        if (nb < std::max<size_t>(karatsuba_cutoff, 4))
+        {
+            mul_schoolbook(a, na, b, nb, r);
+        }
+        else if (2 * nb <= na + 1)
+        {
+            // lopsided: multiply b by nb-limb slices of a
+            std::fill(r, r + na + nb, 0);
+            Limbs t(2 * nb);
+            for (size_t at = 0; at < na; at += nb)
+            {
+                size_t len = std::min(nb, na - at);
+                mul_into(a + at, len, b, nb, t.data());
+                add_into(r + at, na + nb - at, t.data(), len + nb);
+            }
+        }
+        else
+        {
+            // a = a1 B^h + a0, b = b1 B^h + b0, with h < nb <= na <= 2h:
+            // a b = z2 B^2h + (z1 - z2 - z0) B^h + z0, z1 = (a1 + a0)(b1 + b0)
+            size_t h = (na + 1) / 2;
+            mul_into(a, h, b, h, r);
+            mul_into(a + h, na - h, b + h, nb - h, r + 2 * h);
+            Limbs sa(a, a + h), sb(b, b + h);
+            if (add_into(sa.data(), h, a + h, na - h))
+            {
+                sa.push_back(1);
+            }
+            if (add_into(sb.data(), h, b + h, nb - h))
+            {
+                sb.push_back(1);
+            }
+            Limbs z1(sa.size() + sb.size());
+            mul_into(sa.data(), sa.size(), sb.data(), sb.size(), z1.data());
+            sub_into(z1.data(), z1.size(), r, used(r, 2 * h));
+            sub_into(z1.data(), z1.size(), r + 2 * h, used(r + 2 * h, na + nb - 2 * h));
+            trim(z1);
+            add_into(r + h, na + nb - h, z1.data(), z1.size());
+        }
+    }
+
+    static void mul_schoolbook(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* r)
+    {
+        std::fill(r, r + na + nb, 0);
+        for (size_t i = 0; i < na; i++)
+        {
+            unsigned __int128 carry = 0;
+            for (size_t j = 0; j < nb; j++)
+            {
+                carry += (unsigned __int128)a[i] * b[j] + r[i + j];
+                r[i + j] = (uint64_t)carry;
+                carry >>= 64;
+            }
+            r[i + nb] = (uint64_t)carry;
+        }
+    }
+
+    // m = m * f + add
+    static void mul_add_small(Limbs& m, uint64_t f, uint64_t add)
+    {
+        unsigned __int128 carry = add;
+        for (uint64_t& limb : m)
+        {
+            carry += (unsigned __int128)limb * f;
+            limb = (uint64_t)carry;
+            carry >>= 64;
+        }
+        if (carry)
+        {
+            m.push_back((uint64_t)carry);
+        }
+    }
+
+    // q = a / b, r = a % b on magnitudes; b is not zero
+    static void divmod_mag(const Limbs& a, const Limbs& b, Limbs& q, Limbs& r)
+    {
+        if (cmp_mag(a, b) < 0)
+        {
+            q.clear();
+            r = a;
+            return;
+        }
+        if (b.size() == 1)
+        {
+            q = a;
+            uint64_t rem = div_small(q, b[0]);
+            r.clear();
+            if (rem)
+            {
+                r.push_back(rem);
+            }
+            return;
+        }
+        // normalize so the divisor's top bit is set, which keeps each
+        // estimated quotient digit at most two too large
+        int shift = __builtin_clzll(b.back());
+        Limbs v = shift_left(b, shift);
+        Limbs u = shift_left(a, shift);
+        if (u.size() == a.size())
+        {
+            u.push_back(0);
+        }
+        size_t n = v.size();
+        q.assign(a.size() - n + 1, 0);
+        for (size_t j = q.size(); j-- > 0;)
+        {
+            unsigned __int128 top = ((unsigned __int128)u[j + n] << 64) | u[j + n - 1];
+            unsigned __int128 qhat = top / v[n - 1];
+            unsigned __int128 rhat = top % v[n - 1];
+            while ((qhat >> 64) || qhat * v[n - 2] > ((rhat << 64) | u[j + n - 2]))
+            {
+                qhat--;
+                rhat += v[n - 1];
+                if (rhat >> 64)
+                {
+                    break;
+                }
+            }
+            // u[j, j + n] -= qhat * v
+            uint64_t carry = 0;
+            unsigned char borrow = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                unsigned __int128 p = qhat * v[i] + carry;
+                carry = (uint64_t)(p >> 64);
+                unsigned long long d;
+                borrow = __builtin_sub_overflow(u[i + j], (uint64_t)p, &d) | __builtin_sub_overflow(d, (unsigned long long)borrow, &d);
+                u[i + j] = d;
+            }
+            unsigned long long d;
+            bool under = __builtin_sub_overflow(u[j + n], carry, &d) | __builtin_sub_overflow(d, (unsigned long long)borrow, &d);
+            u[j + n] = d;
+            if (under)
+            {
+                // qhat was one too large: add v back
+                qhat--;
+                u[j + n] += add_into(u.data() + j, n, v.data(), n);
+            }
+            q[j] = (uint64_t)qhat;
+        }
+        trim(q);
+        u.resize(n);
+        r = shift_right(u, shift);
+    }
+
+    static Limbs shift_left(const Limbs& m, int shift)
+    {
+        Limbs r(m.size() + 1, 0);
+        for (size_t i = 0; i < m.size(); i++)
+        {
+            r[i] |= m[i] << shift;
+            r[i + 1] = shift ? m[i] >> (64 - shift) : 0;
+        }
+        trim(r);
+        return r;
+    }
+
+    static Limbs shift_right(const Limbs& m, int shift)
+    {
+        Limbs r(m.size());
+        for (size_t i = 0; i < m.size(); i++)
+        {
+            r[i] = m[i] >> shift;
+            if (shift && i + 1 < m.size())
+            {
+                r[i] |= m[i + 1] << (64 - shift);
+            }
+        }
+        trim(r);
+        return r;
+    }
+
+    // appends m in decimal, zero-padded to width digits (0 = no padding)
+    static void append_decimal(const Limbs& m, const std::vector<Limbs>& powers, size_t width, std::string& out)
+    {
+        if (m.size() < decimal_cutoff)
+        {
+            Limbs rest = m;
+            std::vector<uint64_t> chunks;
+            while (!rest.empty())
+            {
+                chunks.push_back(div_small(rest, chunk_base));
+            }
+            // a zero low half of a split is all padding
+            if (chunks.empty())
+            {
+                out.append(width, '0');
+                return;
+            }
+            std::string s = std::to_string(chunks.back());
+            for (size_t i = chunks.size() - 1; i-- > 0;)
+            {
+                std::string part = std::to_string(chunks[i]);
+                s.append(chunk_digits - part.size(), '0');
+                s += part;
+            }
+            if (s.size() < width)
+            {
+                out.append(width - s.size(), '0');
+            }
+            out += s;
+            return;
+        }
+        // the largest power with at most about half of m's limbs
+        size_t level = 0;
+        while (level + 1 < powers.size() && powers[level + 1].size() * 2 <= m.size() + 1)
+        {
+            level++;
+        }
+        Limbs q, r;
+        divmod_mag(m, powers[level], q, r);
+        size_t low_digits = chunk_digits << level;
+        append_decimal(q, powers, width > low_digits ? width - low_digits : 0, out);
+        append_decimal(r, powers, low_digits, out);
+    }
+
+    // m /= d, returning the remainder
+    static uint64_t div_small(Limbs& m, uint64_t d)
+    {
+        unsigned __int128 rem = 0;
+        for (size_t i = m.size(); i-- > 0;)
+        {
+            rem = (rem << 64) | m[i];
+            m[i] = (uint64_t)(rem / d);
+            rem %= d;
+        }
+        trim(m);
+        return (uint64_t)rem;
+    }
+};
+
+#endif
@@ -0,0 +1,139 @@
+// Compile-time command tables.
+//
+// A CommandTable maps both a command's number (the menu choice, or a
+// character code like DecisionMaking.cpp's switch) and its name to one
+// entry holding the handler. Everything is computed by a constexpr
+// constructor: the code lookup is a direct array, and names go through a
+// perfect hash whose seed is searched for at compile time, so a lookup is
+// one hash, one probe and one string compare, with no map built at run
+// time. A table that cannot be built (duplicate name or code, code out of
+// range) fails to compile.
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+template <class Handler>
+struct CommandSpec
+{
+    int code = 0;            // 0..max_code
+    std::string_view name;   // as typed in scripts
+    const char* title = "";  // menu text
+    Handler handler = nullptr;
+};
+
+constexpr uint32_t command_hash(std::string_view s, uint32_t seed)
+{
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : s)
+    {
+        h = (h ^ (unsigned char)c) * 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+template <class Handler, size_t N>
+class CommandTable
+{
+public:
+    static constexpr int max_code = 127;
+    static constexpr size_t slots = []
+    {
+        size_t s = 1;
+        while (s < 2 * N)
+        {
+            s *= 2;
+        }
+        return s;
+    }();
+
+    constexpr explicit CommandTable(const CommandSpec<Handler> (&list)[N])
+        : specs(), by_code(), by_name(), seed(0)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            specs[i] = list[i];
+        }
+        for (int& c : by_code)
+        {
+            c = -1;
+        }
+        for (size_t i = 0; i < N; i++)
+        {
+            if (specs[i].code < 0 || specs[i].code > max_code)
+            {
+                throw "command code out of range";
+            }
+            if (by_code[specs[i].code] >= 0)
+            {
+                throw "duplicate command code";
+            }
+            by_code[specs[i].code] = (int)i;
+            for (size_t j = 0; j < i; j++)
+            {
+                if (specs[i].name == specs[j].name)
+                {
+                    throw "duplicate command name";
+                }
+            }
+        }
+        // try seeds until every name lands in its own slot
+        for (seed = 0;; seed++)
+        {
+            for (int& s : by_name)
+            {
+                s = -1;
+            }
+            bool clash = false;
+            for (size_t i = 0; i < N && !clash; i++)
+            {
+                int& slot = by_name[command_hash(specs[i].name, seed) & (slots - 1)];
+                clash = slot >= 0;
+                slot = (int)i;
+            }
+            if (!clash)
+            {
+                break;
+            }
+        }
+    }
+
+    constexpr size_t size() const
+    {
+        return N;
+    }
+
+    constexpr const CommandSpec<Handler>& operator[](size_t i) const
+    {
+        return specs[i];
+    }
+
+    // index of the command, or -1
+    constexpr int find(int code) const
+    {
+        return code >= 0 && code <= max_code ? by_code[code] : -1;
+    }
+
+    constexpr int find(std::string_view name) const
+    {
+        int i = by_name[command_hash(name, seed) & (slots - 1)];
+        return i >= 0 && specs[i].name == name ? i : -1;
+    }
+
+private:
+    CommandSpec<Handler> specs[N];
+    int by_code[max_code + 1];
+    int by_name[slots];
+    uint32_t seed;
+};
+
+// deduces N from the braced list
+template <class Handler, size_t N>
+constexpr CommandTable<Handler, N> make_command_table(const CommandSpec<Handler> (&list)[N])
+{
+    return CommandTable<Handler, N>(list);
+}
+
+#endif
@@ -1,35 +1,43 @@
 /* there are three control loop structure
     for, while, dowhile, programs */
 
+#include<cstdlib>
 #include<iostream>
+#include"demos.h"
+#include"fibonacci.h"
 using namespace std;
-int main() 
+// fib [terms]: asks for the number of terms when it is not given
+int fib_main(int argc, char** argv)
 {
-    int i,n;
-    cout<<"Enter the number of terms: ";
-    cin>>n;
+    long long n;
+    if(argc>1)
+    n=strtoll(argv[1],nullptr,10);
+    else
+    {
+        cout<<"Enter the number of terms: ";
+        cin>>n;
+    }
     cout<<"Fibonacci Series: ";
-    for(i=0;i<n;i++)
+    FibonacciStream<BigInt> fib;
+    for(long long i=0;i<n;i++)
     {
-        if(i==0)
-        cout<<0;
-        else if(i==1)
-        cout<<1;
-        else
-        {
-            int a=0,b=1;
-            cout<<a<<" "<<b<<" ";
-            for(int j=2;j<i;j++)
-            {
-                int temp=a+b;
-                a=b;
-                b=temp;
-            }
-        }
-        cout<<endl;
+        if(i>0)
+        fib.next();
+        cout<<fib.term().to_string()<<" ";
     }
+    cout<<endl;
 
     return 0;
 }
 
-/* here in above program the concept is that in line 12 to 30 there is logic is present. */
\ No newline at end of file
+#ifndef DEMOS_NO_MAIN
+int main(int argc, char** argv)
+{
+    return fib_main(argc, argv);
+}
+#endif
+
+/* here in above program each pass of the for loop prints the current term and
+   steps the stream once, so n terms cost n additions. The terms are BigInt
+   because int goes wrong after F(46); see fibonacci.h for the O(log k)
+   fast-doubling version that jumps straight to the k-th term. */
@@ -0,0 +1,96 @@
+// One driver for every demo program: each subcommand runs one of them
+// (see demos.h), and several can be chained with "+" to run one after
+// another in the same process, sharing its startup and warm caches.
+//   demo [--time] <command> [args...] [+ <command> [args...]]...
+// e.g. demo fib 90 + classify -7 + students --script day.txt
+// --time reports each command's wall time on stderr. The exit status is
+// that of the last command that failed, or 0.
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "commands.h"
+#include "demos.h"
+using namespace std;
+
+typedef int (*DemoMain)(int argc, char** argv);
+
+static constexpr auto demos = make_command_table<DemoMain>({
+    {1, "fib", "Fibonacci series (controlloops.cpp)", fib_main},
+    {2, "calc", "Operators and the batch calculator (operator.cpp)", calc_main},
+    {3, "classify", "Decision-making statements (DecisionMaking.cpp)", classify_main},
+    {4, "loops", "Loop statements (loops.cpp)", loops_main},
+    {5, "students", "Student records (studentrecord.cpp)", students_main},
+    {6, "welcome", "First program (welcome.cpp)", welcome_main},
+    {7, "number", "Read and print a number (program1.cpp)", number_main},
+});
+
+static void usage(const char* self)
+{
+    cerr << "usage: " << self << " [--time] <command> [args...] [+ <command> [args...]]...\n";
+    for (size_t i = 0; i < demos.size(); i++)
+    {
+        cerr << "  " << demos[i].name << string(10 - demos[i].name.size(), ' ') << demos[i].title << "\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int first = 1;
+    bool timed = false;
+    if (first < argc && string(argv[first]) == "--time")
+    {
+        timed = true;
+        first++;
+    }
+    if (first >= argc)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // split into runs at each "+", checking every name before running any
+    vector<vector<char*>> runs(1);
+    for (int i = first; i < argc; i++)
+    {
+        if (string(argv[i]) == "+")
+        {
+            runs.emplace_back();
+        }
+        else
+        {
+            runs.back().push_back(argv[i]);
+        }
+    }
+    for (const vector<char*>& run : runs)
+    {
+        if (run.empty() || demos.find(run[0]) < 0)
+        {
+            cerr << (run.empty() ? "missing command" : "unknown command " + string(run[0])) << "\n";
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    int status = 0;
+    for (vector<char*>& run : runs)
+    {
+        const auto& demo = demos[demos.find(run[0])];
+        run.push_back(nullptr);
+        auto start = chrono::steady_clock::now();
+        int rc = demo.handler((int)run.size() - 1, run.data());
+        cout.flush();
+        if (timed)
+        {
+            chrono::duration<double, milli> ms = chrono::steady_clock::now() - start;
+            cerr << demo.name << ": " << ms.count() << " ms, exit " << rc << "\n";
+        }
+        if (rc != 0)
+        {
+            status = rc;
+        }
+        // a command that read to the end of input leaves it there for the next
+        cin.clear();
+    }
+    return status;
+}
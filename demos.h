@@ -0,0 +1,31 @@
+// Entry points of the demo programs, so the demo driver (demo.cpp) can
+// run any of them, or several one after another, in a single process.
+//
+// Each program's source file still ends with a main() of its own that
+// calls its entry point, so `g++ loops.cpp` keeps working; the CMake build
+// compiles them with DEMOS_NO_MAIN into the demo_kernels library instead.
+#ifndef DEMOS_H
+#define DEMOS_H
+
+// DecisionMaking.cpp: classify [n]
+int classify_main(int argc, char** argv);
+
+// loops.cpp: loops [n]
+int loops_main(int argc, char** argv);
+
+// operator.cpp: calc [--operators | --batch ...]
+int calc_main(int argc, char** argv);
+
+// controlloops.cpp: fib [terms]
+int fib_main(int argc, char** argv);
+
+// studentrecord.cpp: students [options]
+int students_main(int argc, char** argv);
+
+// welcome.cpp
+int welcome_main(int argc, char** argv);
+
+// program1.cpp
+int number_main(int argc, char** argv);
+
+#endif
@@ -0,0 +1,153 @@
+// Epoch-based reclamation: the userspace RCU scheme behind the lock-free
+// read path of ShardedRegistry.
+//
+// A reader brackets its accesses with an EpochGuard, which publishes the
+// global epoch it started in. A writer that unlinks an object calls
+// retire_epoch() (which also advances the global epoch) and keeps the
+// object until safe_to_free() says every active reader started after it
+// was unlinked. Readers never block and never write shared memory other
+// than their own slot.
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// full fence between a thread's store and its later loads. TSan does not
+// model fences (and warns about them); the seq_cst read-modify-writes next
+// to each fence are what it sees instead.
+inline void epoch_fence()
+{
+#ifndef __SANITIZE_THREAD__
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+}
+
+class EpochDomain
+{
+public:
+    static const size_t max_threads = 256;
+
+    static EpochDomain& instance()
+    {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // called by a writer after unlinking an object; the object may be
+    // freed once safe_to_free(returned epoch) holds
+    uint64_t retire_epoch()
+    {
+        epoch_fence();
+        return global.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    // true if no reader that might still see an object retired at epoch
+    // is inside a critical section
+    bool safe_to_free(uint64_t epoch) const
+    {
+        return oldest_active() > epoch;
+    }
+
+    uint64_t oldest_active() const
+    {
+        uint64_t oldest = UINT64_MAX;
+        for (const Slot& s : slots)
+        {
+            uint64_t e = s.epoch.load(std::memory_order_seq_cst);
+            if (e != 0 && e < oldest)
+            {
+                oldest = e;
+            }
+        }
+        return oldest;
+    }
+
+    void enter()
+    {
+        Slot& s = my_slot();
+        if (s.depth++ == 0)
+        {
+            s.epoch.exchange(global.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            // the reader's loads must not move above its published epoch
+            epoch_fence();
+        }
+    }
+
+    void exit()
+    {
+        Slot& s = my_slot();
+        if (--s.depth == 0)
+        {
+            s.epoch.store(0, std::memory_order_release);
+        }
+    }
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> epoch{0};  // 0 = not reading
+        std::atomic<bool> owned{false};
+        int depth = 0;                   // only touched by the owner
+    };
+
+    // gives the slot back when its thread exits
+    struct SlotLease
+    {
+        Slot* slot = nullptr;
+
+        ~SlotLease()
+        {
+            if (slot)
+            {
+                slot->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    std::atomic<uint64_t> global{1};
+    Slot slots[max_threads];
+
+    Slot& my_slot()
+    {
+        thread_local SlotLease lease;
+        if (!lease.slot)
+        {
+            for (Slot& s : slots)
+            {
+                bool expected = false;
+                if (s.owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                {
+                    lease.slot = &s;
+                    break;
+                }
+            }
+            if (!lease.slot)
+            {
+                std::abort();  // more than max_threads concurrent readers
+            }
+        }
+        return *lease.slot;
+    }
+};
+
+class EpochGuard
+{
+public:
+    EpochGuard()
+    {
+        EpochDomain::instance().enter();
+    }
+
+    ~EpochGuard()
+    {
+        EpochDomain::instance().exit();
+    }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+#endif
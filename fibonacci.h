@@ -0,0 +1,142 @@
+// Fibonacci numbers, F(0) = 0, F(1) = 1.
+//
+// controlloops.cpp restarted the recurrence from F(0) for every term, so
+// n terms cost O(n^2) additions, and kept them in int, which wraps after
+// F(46). Here a FibonacciStream yields consecutive terms for one addition
+// each, and fast doubling computes any single F(k) in O(log k) steps:
+//   F(2k) = F(k) * (2 F(k+1) - F(k))
+//   F(2k+1) = F(k)^2 + F(k+1)^2
+// Terms can be unsigned 64-bit, checked against overflow, or BigInt for
+// exact values of any size.
+#ifndef FIBONACCI_H
+#define FIBONACCI_H
+
+#include <cstdint>
+#include <utility>
+
+#include "bigint.h"
+
+// F(93) is the largest term that fits in 64 bits
+const uint64_t fib_max_u64 = 93;
+
+// a += b, false if the sum does not fit
+inline bool fib_add(uint64_t& a, uint64_t b)
+{
+    return !__builtin_add_overflow(a, b, &a);
+}
+
+inline bool fib_add(BigInt& a, const BigInt& b)
+{
+    a += b;
+    return true;
+}
+
+// F(0), F(1), F(2), ... one addition per term; T is uint64_t or BigInt
+template <class T>
+class FibonacciStream
+{
+public:
+    uint64_t index() const
+    {
+        return k;
+    }
+
+    // F(index())
+    const T& term() const
+    {
+        return a;
+    }
+
+    // advances to the next term; for uint64_t, false (and no move) once
+    // the next term would overflow
+    bool next()
+    {
+        if (!next_fits)
+        {
+            return false;
+        }
+        // (a, b) = (b, a + b), without a temporary
+        next_fits = fib_add(a, b);
+        std::swap(a, b);
+        k++;
+        return true;
+    }
+
+private:
+    T a = 0;
+    T b = 1;
+    uint64_t k = 0;
+    bool next_fits = true;  // b holds F(k + 1) exactly
+};
+
+// F(k) mod 2^64; exact for k <= fib_max_u64
+inline uint64_t fib_mod64(uint64_t k)
+{
+    uint64_t a = 0, b = 1;  // F(j), F(j + 1) for the bits of k seen so far
+    for (int bit = 63 - (k ? __builtin_clzll(k) : 63); bit >= 0; bit--)
+    {
+        uint64_t c = a * (2 * b - a);
+        uint64_t d = a * a + b * b;
+        if ((k >> bit) & 1)
+        {
+            a = d;
+            b = c + d;
+        }
+        else
+        {
+            a = c;
+            b = d;
+        }
+    }
+    return a;
+}
+
+// F(k) into out, or false if it does not fit in 64 bits
+inline bool fib_checked(uint64_t k, uint64_t& out)
+{
+    if (k > fib_max_u64)
+    {
+        return false;
+    }
+    out = fib_mod64(k);
+    return true;
+}
+
+// exact F(k)
+inline BigInt fibonacci(uint64_t k)
+{
+    if (k <= fib_max_u64)
+    {
+        return BigInt(fib_mod64(k));
+    }
+    // start from a prefix of k's bits whose terms still fit in 64 bits
+    int shift = 63 - __builtin_clzll(k);
+    while ((k >> shift) < fib_max_u64 / 2)
+    {
+        shift--;
+    }
+    BigInt a = fib_mod64(k >> shift);
+    BigInt b = fib_mod64((k >> shift) + 1);
+    for (int bit = shift - 1; bit >= 0; bit--)
+    {
+        BigInt c = b + b;
+        c -= a;
+        c = a * c;
+        BigInt d = a * a;
+        d += b * b;
+        if ((k >> bit) & 1)
+        {
+            a = std::move(d);
+            b = std::move(c);
+            b += a;
+        }
+        else
+        {
+            a = std::move(c);
+            b = std::move(d);
+        }
+    }
+    return a;
+}
+
+#endif
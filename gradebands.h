@@ -0,0 +1,255 @@
+// Table-driven banding of values such as student percentages.
+//
+// DecisionMaking.cpp's if/else-if ladders (child / growing stage / adult)
+// pick a band by testing conditions one after another, so every value
+// costs a chain of unpredictable branches. Here a ladder is a table:
+// ascending lower bounds, one label per band. A value's band is simply
+// the number of bounds it reaches, which needs no branches at all, and
+// SIMD versions compare 8 (AVX2) or 4 (SSE4.1) values against each bound
+// at once and add up the comparison masks.
+#ifndef GRADEBANDS_H
+#define GRADEBANDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "markkernels.h"
+
+class GradeBands
+{
+public:
+    static const size_t max_bands = 16;
+
+    // bounds are the ascending lower bounds of bands 1..n (band 0 is
+    // everything below the first); labels names each of the n + 1 bands
+    bool set(const std::vector<float>& bounds, const std::vector<std::string>& labels, std::string& error)
+    {
+        if (bounds.size() + 1 > max_bands)
+        {
+            error = "at most " + std::to_string(max_bands) + " bands are supported";
+            return false;
+        }
+        if (labels.size() != bounds.size() + 1)
+        {
+            error = "need one label per band (" + std::to_string(bounds.size() + 1) + ")";
+            return false;
+        }
+        for (size_t i = 1; i < bounds.size(); i++)
+        {
+            if (!(bounds[i - 1] < bounds[i]))
+            {
+                error = "band bounds must be strictly ascending";
+                return false;
+            }
+        }
+        this->bounds = bounds;
+        this->labels = labels;
+        return true;
+    }
+
+    // F below 60, then D, C, B and A from 90
+    static GradeBands letter_grades()
+    {
+        GradeBands g;
+        std::string error;
+        g.set({60, 70, 80, 90}, {"F", "D", "C", "B", "A"}, error);
+        return g;
+    }
+
+    // the age ladder from DecisionMaking.cpp: under 13, 13 to 18, older
+    static GradeBands age_stages()
+    {
+        GradeBands g;
+        std::string error;
+        g.set({13, 19}, {"child", "Growing stage", "adult"}, error);
+        return g;
+    }
+
+    size_t size() const
+    {
+        return labels.size();
+    }
+
+    const std::string& label(size_t band) const
+    {
+        return labels[band];
+    }
+
+    unsigned band(float x) const
+    {
+        unsigned b = 0;
+        for (float t : bounds)
+        {
+            b += x >= t;
+        }
+        return b;
+    }
+
+    // out[i] = band of x[i]
+    void classify(const float* x, size_t n, uint8_t* out, SimdLevel level = detect_simd()) const
+    {
+        size_t i = 0;
+#ifdef MARKKERNELS_X86
+        if (level == SimdLevel::AVX2)
+        {
+            i = classify_avx2(x, n, out);
+        }
+        else if (level == SimdLevel::SSE41)
+        {
+            i = classify_sse41(x, n, out);
+        }
+#endif
+        (void)level;
+        for (; i < n; i++)
+        {
+            out[i] = (uint8_t)band(x[i]);
+        }
+    }
+
+    // counts[b] = number of values in band b; counts has size() entries
+    void count(const float* x, size_t n, size_t* counts, SimdLevel level = detect_simd()) const
+    {
+        // reached[j] = values at or above bound j
+        size_t reached[max_bands] = {0};
+        size_t i = 0;
+#ifdef MARKKERNELS_X86
+        if (level == SimdLevel::AVX2)
+        {
+            i = count_avx2(x, n, reached);
+        }
+        else if (level == SimdLevel::SSE41)
+        {
+            i = count_sse41(x, n, reached);
+        }
+#endif
+        (void)level;
+        for (; i < n; i++)
+        {
+            for (size_t j = 0; j < bounds.size(); j++)
+            {
+                reached[j] += x[i] >= bounds[j];
+            }
+        }
+        size_t below = n;
+        for (size_t j = 0; j < bounds.size(); j++)
+        {
+            counts[j] = below - reached[j];
+            below = reached[j];
+        }
+        counts[bounds.size()] = below;
+    }
+
+private:
+    std::vector<float> bounds;
+    std::vector<std::string> labels = {"all"};
+
+    static const size_t count_block = 2048;
+
+#ifdef MARKKERNELS_X86
+    // each comparison mask lane is -1 where x >= bound, so subtracting
+    // the masks counts bounds reached
+    __attribute__((target("avx2"))) __m256i bands_avx2(const float* x) const
+    {
+        __m256 v = _mm256_loadu_ps(x);
+        __m256i b = _mm256_setzero_si256();
+        for (float t : bounds)
+        {
+            b = _mm256_sub_epi32(b, _mm256_castps_si256(_mm256_cmp_ps(v, _mm256_set1_ps(t), _CMP_GE_OQ)));
+        }
+        return b;
+    }
+
+    __attribute__((target("avx2"))) size_t classify_avx2(const float* x, size_t n, uint8_t* out) const
+    {
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            __m256i ab = _mm256_packs_epi32(bands_avx2(x + i), bands_avx2(x + i + 8));
+            __m256i cd = _mm256_packs_epi32(bands_avx2(x + i + 16), bands_avx2(x + i + 24));
+            // packs work within 128-bit lanes; put the 4-byte groups back in order
+            __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(ab, cd), order);
+            _mm256_storeu_si256((__m256i*)(out + i), bytes);
+        }
+        return i;
+    }
+
+    // one block at a time so the values stay in L1 across the bounds
+    __attribute__((target("avx2"))) size_t count_avx2(const float* x, size_t n, size_t* reached) const
+    {
+        size_t end = n - n % 8;
+        for (size_t block = 0; block < end; block += count_block)
+        {
+            size_t block_end = block + count_block < end ? block + count_block : end;
+            for (size_t j = 0; j < bounds.size(); j++)
+            {
+                const __m256 t = _mm256_set1_ps(bounds[j]);
+                __m256i acc = _mm256_setzero_si256();
+                for (size_t i = block; i < block_end; i += 8)
+                {
+                    acc = _mm256_sub_epi32(acc, _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(x + i), t, _CMP_GE_OQ)));
+                }
+                uint32_t lanes[8];
+                _mm256_storeu_si256((__m256i*)lanes, acc);
+                for (uint32_t c : lanes)
+                {
+                    reached[j] += c;
+                }
+            }
+        }
+        return end;
+    }
+
+    __attribute__((target("sse4.1"))) __m128i bands_sse41(const float* x) const
+    {
+        __m128 v = _mm_loadu_ps(x);
+        __m128i b = _mm_setzero_si128();
+        for (float t : bounds)
+        {
+            b = _mm_sub_epi32(b, _mm_castps_si128(_mm_cmpge_ps(v, _mm_set1_ps(t))));
+        }
+        return b;
+    }
+
+    __attribute__((target("sse4.1"))) size_t classify_sse41(const float* x, size_t n, uint8_t* out) const
+    {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i ab = _mm_packs_epi32(bands_sse41(x + i), bands_sse41(x + i + 4));
+            __m128i cd = _mm_packs_epi32(bands_sse41(x + i + 8), bands_sse41(x + i + 12));
+            _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(ab, cd));
+        }
+        return i;
+    }
+
+    __attribute__((target("sse4.1"))) size_t count_sse41(const float* x, size_t n, size_t* reached) const
+    {
+        size_t end = n - n % 4;
+        for (size_t block = 0; block < end; block += count_block)
+        {
+            size_t block_end = block + count_block < end ? block + count_block : end;
+            for (size_t j = 0; j < bounds.size(); j++)
+            {
+                const __m128 t = _mm_set1_ps(bounds[j]);
+                __m128i acc = _mm_setzero_si128();
+                for (size_t i = block; i < block_end; i += 4)
+                {
+                    acc = _mm_sub_epi32(acc, _mm_castps_si128(_mm_cmpge_ps(_mm_loadu_ps(x + i), t)));
+                }
+                uint32_t lanes[4];
+                _mm_storeu_si128((__m128i*)lanes, acc);
+                for (uint32_t c : lanes)
+                {
+                    reached[j] += c;
+                }
+            }
+        }
+        return end;
+    }
+#endif
+};
+
+#endif
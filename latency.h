@@ -0,0 +1,380 @@
+// Low-overhead latency recording for hot operations.
+//
+// A LatencyScope at the top of an operation reads the cycle counter
+// (rdtsc on x86, steady_clock elsewhere) on entry and on exit, and adds
+// the difference to the calling thread's histogram for that operation.
+// Every thread records into a slot of its own, so recording is a few
+// uncontended relaxed stores and never takes a lock; snapshot() merges
+// the slots when a report is wanted.
+//
+// Histograms are HDR-style: a value is bucketed by its power of two and
+// then by 32 linear steps within it, so any percentile read back is within
+// about 3% of the exact value, from single cycles up to minutes, in a
+// fixed 9 KB per operation.
+//
+// Building with -DLATENCY_DISABLED makes LatencyScope an empty object and
+// latency_enabled false, so the instrumentation compiles away entirely.
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define LATENCY_RDTSC 1
+#include <x86intrin.h>
+#endif
+
+#ifdef LATENCY_DISABLED
+constexpr bool latency_enabled = false;
+#else
+constexpr bool latency_enabled = true;
+#endif
+
+inline uint64_t latency_steady_ns()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// the clock LatencyScope reads; latency_ns_per_tick() converts
+inline uint64_t latency_ticks()
+{
+#ifdef LATENCY_RDTSC
+    return __rdtsc();
+#else
+    return latency_steady_ns();
+#endif
+}
+
+// measured once against steady_clock over a few milliseconds
+inline double latency_ns_per_tick()
+{
+#ifdef LATENCY_RDTSC
+    static const double ratio = []
+    {
+        uint64_t ns0 = latency_steady_ns(), t0 = latency_ticks();
+        uint64_t ns1 = ns0;
+        while (ns1 - ns0 < 5000000)
+        {
+            ns1 = latency_steady_ns();
+        }
+        uint64_t t1 = latency_ticks();
+        return t1 > t0 ? (double)(ns1 - ns0) / (double)(t1 - t0) : 1.0;
+    }();
+    return ratio;
+#else
+    return 1.0;
+#endif
+}
+
+class LatencyHistogram
+{
+public:
+    static const int sub_bits = 5;
+    static const size_t sub_buckets = size_t(1) << sub_bits;
+    // values of 2^41 ticks and more share the last bucket
+    static const int max_shift = 35;
+    static const size_t bucket_count = (max_shift + 2) * sub_buckets;
+
+    static size_t bucket_of(uint64_t v)
+    {
+        if (v < 2 * sub_buckets)
+        {
+            return (size_t)v;
+        }
+        int shift = 63 - __builtin_clzll(v) - sub_bits;
+        if (shift > max_shift)
+        {
+            return bucket_count - 1;
+        }
+        return (size_t)shift * sub_buckets + (size_t)(v >> shift);
+    }
+
+    // the largest value that falls in bucket b
+    static uint64_t bucket_high(size_t b)
+    {
+        if (b < 2 * sub_buckets)
+        {
+            return b;
+        }
+        size_t shift = b / sub_buckets - 1;
+        uint64_t mantissa = b % sub_buckets + sub_buckets;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    LatencyHistogram() : counts(bucket_count, 0) {}
+
+    void record(uint64_t v)
+    {
+        counts[bucket_of(v)]++;
+        n++;
+        total += v;
+        highest = v > highest ? v : highest;
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        for (size_t b = 0; b < bucket_count; b++)
+        {
+            counts[b] += other.counts[b];
+        }
+        n += other.n;
+        total += other.total;
+        highest = other.highest > highest ? other.highest : highest;
+    }
+
+    void clear()
+    {
+        std::fill(counts.begin(), counts.end(), 0);
+        n = 0;
+        total = 0;
+        highest = 0;
+    }
+
+    uint64_t count() const
+    {
+        return n;
+    }
+
+    uint64_t sum() const
+    {
+        return total;
+    }
+
+    uint64_t max() const
+    {
+        return highest;
+    }
+
+    double mean() const
+    {
+        return n ? (double)total / (double)n : 0.0;
+    }
+
+    // 1-based nearest rank of percentile p among n values: ceil(p% of n),
+    // in whole numbers of parts per million so no rounding of p / 100 * n
+    // can move it, clamped to [1, n]
+    static uint64_t rank_of(double p, uint64_t n)
+    {
+        uint64_t ppm = (uint64_t)(p * 10000.0 + 0.5);
+        uint64_t rank = (uint64_t)(((unsigned __int128)ppm * n + 999999) / 1000000);
+        return rank < 1 ? 1 : rank > n ? n : rank;
+    }
+
+    // nearest-rank percentile, p in [0, 100], reported as the top of its
+    // bucket (never above the largest value recorded)
+    uint64_t percentile(double p) const
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+        uint64_t rank = rank_of(p, n);
+        for (size_t b = 0; b < bucket_count; b++)
+        {
+            if (rank <= counts[b])
+            {
+                uint64_t high = bucket_high(b);
+                return high < highest ? high : highest;
+            }
+            rank -= counts[b];
+        }
+        return highest;
+    }
+
+private:
+    friend class LatencyRecorder;
+
+    std::vector<uint64_t> counts;
+    uint64_t n = 0;
+    uint64_t total = 0;
+    uint64_t highest = 0;
+};
+
+class LatencyRecorder
+{
+public:
+    static const size_t max_ops = 16;
+    static const size_t max_threads = 256;
+
+    static LatencyRecorder& instance()
+    {
+        static LatencyRecorder recorder;
+        return recorder;
+    }
+
+    ~LatencyRecorder()
+    {
+        for (std::atomic<Slot*>& s : slots)
+        {
+            delete s.load(std::memory_order_acquire);
+        }
+    }
+
+    void record(size_t op, uint64_t ticks)
+    {
+        Slot& s = my_slot();
+        bump(s.counts[op][LatencyHistogram::bucket_of(ticks)], 1);
+        bump(s.sums[op], ticks);
+        if (ticks > s.maxima[op].load(std::memory_order_relaxed))
+        {
+            s.maxima[op].store(ticks, std::memory_order_relaxed);
+        }
+    }
+
+    // every thread's recordings of op so far, in ticks
+    LatencyHistogram snapshot(size_t op) const
+    {
+        LatencyHistogram h;
+        for (const std::atomic<Slot*>& p : slots)
+        {
+            const Slot* s = p.load(std::memory_order_acquire);
+            if (!s)
+            {
+                continue;
+            }
+            for (size_t b = 0; b < LatencyHistogram::bucket_count; b++)
+            {
+                uint64_t c = s->counts[op][b].load(std::memory_order_relaxed);
+                h.counts[b] += c;
+                h.n += c;
+            }
+            h.total += s->sums[op].load(std::memory_order_relaxed);
+            uint64_t m = s->maxima[op].load(std::memory_order_relaxed);
+            h.highest = m > h.highest ? m : h.highest;
+        }
+        return h;
+    }
+
+    // wall time since the recorder was first used or last reset, for throughput
+    double seconds() const
+    {
+        return (double)(latency_steady_ns() - start_ns.load(std::memory_order_relaxed)) * 1e-9;
+    }
+
+    // zeroes every slot; recordings racing with it may survive
+    void reset()
+    {
+        for (std::atomic<Slot*>& p : slots)
+        {
+            Slot* s = p.load(std::memory_order_acquire);
+            if (!s)
+            {
+                continue;
+            }
+            for (size_t op = 0; op < max_ops; op++)
+            {
+                for (std::atomic<uint64_t>& c : s->counts[op])
+                {
+                    c.store(0, std::memory_order_relaxed);
+                }
+                s->sums[op].store(0, std::memory_order_relaxed);
+                s->maxima[op].store(0, std::memory_order_relaxed);
+            }
+        }
+        start_ns.store(latency_steady_ns(), std::memory_order_relaxed);
+    }
+
+private:
+    // written only by its owning thread, read by snapshot() at any time
+    struct Slot
+    {
+        std::atomic<bool> owned{false};
+        std::atomic<uint64_t> counts[max_ops][LatencyHistogram::bucket_count];
+        std::atomic<uint64_t> sums[max_ops];
+        std::atomic<uint64_t> maxima[max_ops];
+    };
+
+    // gives the slot, and what it recorded, to the next new thread
+    struct SlotLease
+    {
+        Slot* slot = nullptr;
+
+        ~SlotLease()
+        {
+            if (slot)
+            {
+                slot->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    std::atomic<Slot*> slots[max_threads] = {};
+    std::atomic<uint64_t> start_ns{latency_steady_ns()};
+
+    // single writer, so no read-modify-write is needed
+    static void bump(std::atomic<uint64_t>& a, uint64_t by)
+    {
+        a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    Slot& my_slot()
+    {
+        thread_local SlotLease lease;
+        if (!lease.slot)
+        {
+            lease.slot = acquire_slot();
+        }
+        return *lease.slot;
+    }
+
+    Slot* acquire_slot()
+    {
+        for (std::atomic<Slot*>& p : slots)
+        {
+            Slot* s = p.load(std::memory_order_acquire);
+            if (!s)
+            {
+                Slot* fresh = new Slot();  // value-initialized: all zero
+                fresh->owned.store(true, std::memory_order_relaxed);
+                if (p.compare_exchange_strong(s, fresh, std::memory_order_acq_rel))
+                {
+                    return fresh;
+                }
+                delete fresh;
+            }
+            bool expected = false;
+            if (s->owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+            {
+                return s;
+            }
+        }
+        std::abort();  // more than max_threads threads recording at once
+    }
+};
+
+#ifndef LATENCY_DISABLED
+// times its own lifetime as one occurrence of op
+class LatencyScope
+{
+public:
+    explicit LatencyScope(size_t op) : op(op), start(latency_ticks()) {}
+
+    ~LatencyScope()
+    {
+        LatencyRecorder::instance().record(op, latency_ticks() - start);
+    }
+
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator=(const LatencyScope&) = delete;
+
+private:
+    size_t op;
+    uint64_t start;
+};
+#else
+class LatencyScope
+{
+public:
+    explicit LatencyScope(size_t) {}
+};
+#endif
+
+#endif
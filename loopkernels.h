@@ -0,0 +1,124 @@
+// The loop forms of loops.cpp as kernels over an array, so they can be
+// timed and their machine code compared (see bench/loops_bench.cpp).
+//
+// Each group computes the same result with a different loop statement:
+// a sum with for, while and do-while; a search that stops early with a
+// for loop and break, or with the test folded into a while condition; and
+// a filtered sum that skips values with continue, or with an if around
+// the body. The kernels are kept out of line so that each has its own
+// symbol to disassemble and time.
+#ifndef LOOPKERNELS_H
+#define LOOPKERNELS_H
+
+#include <cstddef>
+
+typedef long long (*LoopKernel)(const int* a, size_t n, int key);
+
+struct LoopKernelInfo
+{
+    const char* group;  // kernels in a group return the same value
+    const char* name;
+    LoopKernel kernel;
+};
+
+__attribute__((noinline)) inline long long loop_sum_for(const int* a, size_t n, int)
+{
+    long long sum = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        sum += a[i];
+    }
+    return sum;
+}
+
+__attribute__((noinline)) inline long long loop_sum_while(const int* a, size_t n, int)
+{
+    long long sum = 0;
+    size_t i = 0;
+    while (i < n)
+    {
+        sum += a[i];
+        i++;
+    }
+    return sum;
+}
+
+__attribute__((noinline)) inline long long loop_sum_do_while(const int* a, size_t n, int)
+{
+    long long sum = 0;
+    size_t i = 0;
+    if (n == 0)
+    {
+        return sum;
+    }
+    do
+    {
+        sum += a[i];
+        i++;
+    } while (i < n);
+    return sum;
+}
+
+// index of the first element equal to key, or n
+__attribute__((noinline)) inline long long loop_find_break(const int* a, size_t n, int key)
+{
+    size_t i;
+    for (i = 0; i < n; i++)
+    {
+        if (a[i] == key)
+        {
+            break;
+        }
+    }
+    return (long long)i;
+}
+
+__attribute__((noinline)) inline long long loop_find_while(const int* a, size_t n, int key)
+{
+    size_t i = 0;
+    while (i < n && a[i] != key)
+    {
+        i++;
+    }
+    return (long long)i;
+}
+
+// sum of the elements below key
+__attribute__((noinline)) inline long long loop_filter_continue(const int* a, size_t n, int key)
+{
+    long long sum = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (a[i] >= key)
+        {
+            continue;
+        }
+        sum += a[i];
+    }
+    return sum;
+}
+
+__attribute__((noinline)) inline long long loop_filter_if(const int* a, size_t n, int key)
+{
+    long long sum = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (a[i] < key)
+        {
+            sum += a[i];
+        }
+    }
+    return sum;
+}
+
+inline const LoopKernelInfo loop_kernels[] = {
+    {"sum", "for", loop_sum_for},
+    {"sum", "while", loop_sum_while},
+    {"sum", "do-while", loop_sum_do_while},
+    {"find", "for + break", loop_find_break},
+    {"find", "while condition", loop_find_while},
+    {"filter", "for + continue", loop_filter_continue},
+    {"filter", "for + if", loop_filter_if},
+};
+
+#endif
@@ -0,0 +1,300 @@
+// Vectorized analytics over the registry's mark columns: per-student
+// totals and percentages, and per-column sum/min/max for class averages.
+// Each kernel has a scalar, SSE4.1 and AVX2 version; the best one the CPU
+// supports is picked at run time, so a plain build still gets AVX2.
+#ifndef MARKKERNELS_H
+#define MARKKERNELS_H
+
+#include <climits>
+#include <cstddef>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MARKKERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// four mark columns of n students each
+struct MarkColumns
+{
+    const int* col[4];
+    size_t n;
+};
+
+struct ColumnStats
+{
+    long long sum = 0;
+    int min = 0;
+    int max = 0;
+    size_t n = 0;
+
+    double mean() const
+    {
+        return n ? (double)sum / (double)n : 0.0;
+    }
+};
+
+enum class SimdLevel
+{
+    Scalar,
+    SSE41,
+    AVX2
+};
+
+inline SimdLevel detect_simd()
+{
+    static const SimdLevel level = []
+    {
+#ifdef MARKKERNELS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return SimdLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.1"))
+        {
+            return SimdLevel::SSE41;
+        }
+#endif
+        return SimdLevel::Scalar;
+    }();
+    return level;
+}
+
+inline const char* simd_name(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::SSE41:
+        return "sse4.1";
+    default:
+        return "scalar";
+    }
+}
+
+namespace mark_simd
+{
+
+inline void totals_scalar(const MarkColumns& m, size_t begin, int* out)
+{
+    for (size_t i = begin; i < m.n; i++)
+    {
+        out[i] = m.col[0][i] + m.col[1][i] + m.col[2][i] + m.col[3][i];
+    }
+}
+
+inline void percentages_scalar(const MarkColumns& m, size_t begin, float* out, int max_total)
+{
+    for (size_t i = begin; i < m.n; i++)
+    {
+        int total = m.col[0][i] + m.col[1][i] + m.col[2][i] + m.col[3][i];
+        out[i] = (float)total * 100.0f / (float)max_total;
+    }
+}
+
+inline void stats_scalar(const int* col, size_t begin, size_t n, ColumnStats& s)
+{
+    for (size_t i = begin; i < n; i++)
+    {
+        s.sum += col[i];
+        s.min = col[i] < s.min ? col[i] : s.min;
+        s.max = col[i] > s.max ? col[i] : s.max;
+    }
+}
+
+#ifdef MARKKERNELS_X86
+
+__attribute__((target("sse4.1"))) inline void totals_sse41(const MarkColumns& m, int* out)
+{
+    size_t i = 0;
+    for (; i + 4 <= m.n; i += 4)
+    {
+        __m128i t = _mm_add_epi32(
+            _mm_add_epi32(_mm_loadu_si128((const __m128i*)(m.col[0] + i)),
+                          _mm_loadu_si128((const __m128i*)(m.col[1] + i))),
+            _mm_add_epi32(_mm_loadu_si128((const __m128i*)(m.col[2] + i)),
+                          _mm_loadu_si128((const __m128i*)(m.col[3] + i))));
+        _mm_storeu_si128((__m128i*)(out + i), t);
+    }
+    totals_scalar(m, i, out);
+}
+
+__attribute__((target("avx2"))) inline void totals_avx2(const MarkColumns& m, int* out)
+{
+    size_t i = 0;
+    for (; i + 8 <= m.n; i += 8)
+    {
+        __m256i t = _mm256_add_epi32(
+            _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(m.col[0] + i)),
+                             _mm256_loadu_si256((const __m256i*)(m.col[1] + i))),
+            _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(m.col[2] + i)),
+                             _mm256_loadu_si256((const __m256i*)(m.col[3] + i))));
+        _mm256_storeu_si256((__m256i*)(out + i), t);
+    }
+    totals_scalar(m, i, out);
+}
+
+__attribute__((target("sse4.1"))) inline void percentages_sse41(const MarkColumns& m, float* out,
+                                                                int max_total)
+{
+    const __m128 hundred = _mm_set1_ps(100.0f);
+    const __m128 denom = _mm_set1_ps((float)max_total);
+    size_t i = 0;
+    for (; i + 4 <= m.n; i += 4)
+    {
+        __m128i t = _mm_add_epi32(
+            _mm_add_epi32(_mm_loadu_si128((const __m128i*)(m.col[0] + i)),
+                          _mm_loadu_si128((const __m128i*)(m.col[1] + i))),
+            _mm_add_epi32(_mm_loadu_si128((const __m128i*)(m.col[2] + i)),
+                          _mm_loadu_si128((const __m128i*)(m.col[3] + i))));
+        _mm_storeu_ps(out + i, _mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(t), hundred), denom));
+    }
+    percentages_scalar(m, i, out, max_total);
+}
+
+__attribute__((target("avx2"))) inline void percentages_avx2(const MarkColumns& m, float* out,
+                                                             int max_total)
+{
+    const __m256 hundred = _mm256_set1_ps(100.0f);
+    const __m256 denom = _mm256_set1_ps((float)max_total);
+    size_t i = 0;
+    for (; i + 8 <= m.n; i += 8)
+    {
+        __m256i t = _mm256_add_epi32(
+            _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(m.col[0] + i)),
+                             _mm256_loadu_si256((const __m256i*)(m.col[1] + i))),
+            _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(m.col[2] + i)),
+                             _mm256_loadu_si256((const __m256i*)(m.col[3] + i))));
+        _mm256_storeu_ps(out + i,
+                         _mm256_div_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(t), hundred), denom));
+    }
+    percentages_scalar(m, i, out, max_total);
+}
+
+// sums are widened to 64 bits per lane so 10^7+ marks cannot overflow
+__attribute__((target("sse4.1"))) inline void stats_sse41(const int* col, size_t n, ColumnStats& s)
+{
+    __m128i sum_lo = _mm_setzero_si128();
+    __m128i sum_hi = _mm_setzero_si128();
+    __m128i vmin = _mm_set1_epi32(s.min);
+    __m128i vmax = _mm_set1_epi32(s.max);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(col + i));
+        sum_lo = _mm_add_epi64(sum_lo, _mm_cvtepi32_epi64(v));
+        sum_hi = _mm_add_epi64(sum_hi, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+        vmin = _mm_min_epi32(vmin, v);
+        vmax = _mm_max_epi32(vmax, v);
+    }
+    long long lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, _mm_add_epi64(sum_lo, sum_hi));
+    int mins[4], maxs[4];
+    _mm_storeu_si128((__m128i*)mins, vmin);
+    _mm_storeu_si128((__m128i*)maxs, vmax);
+    s.sum += lanes[0] + lanes[1];
+    for (int k = 0; k < 4; k++)
+    {
+        s.min = mins[k] < s.min ? mins[k] : s.min;
+        s.max = maxs[k] > s.max ? maxs[k] : s.max;
+    }
+    stats_scalar(col, i, n, s);
+}
+
+__attribute__((target("avx2"))) inline void stats_avx2(const int* col, size_t n, ColumnStats& s)
+{
+    __m256i sum_lo = _mm256_setzero_si256();
+    __m256i sum_hi = _mm256_setzero_si256();
+    __m256i vmin = _mm256_set1_epi32(s.min);
+    __m256i vmax = _mm256_set1_epi32(s.max);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(col + i));
+        sum_lo = _mm256_add_epi64(sum_lo, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        sum_hi = _mm256_add_epi64(sum_hi, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+        vmin = _mm256_min_epi32(vmin, v);
+        vmax = _mm256_max_epi32(vmax, v);
+    }
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(sum_lo, sum_hi));
+    int mins[8], maxs[8];
+    _mm256_storeu_si256((__m256i*)mins, vmin);
+    _mm256_storeu_si256((__m256i*)maxs, vmax);
+    s.sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (int k = 0; k < 8; k++)
+    {
+        s.min = mins[k] < s.min ? mins[k] : s.min;
+        s.max = maxs[k] > s.max ? maxs[k] : s.max;
+    }
+    stats_scalar(col, i, n, s);
+}
+
+#endif
+
+} // namespace mark_simd
+
+// out[i] = sum of student i's four marks
+inline void student_totals(const MarkColumns& m, int* out, SimdLevel level = detect_simd())
+{
+#ifdef MARKKERNELS_X86
+    if (level == SimdLevel::AVX2)
+    {
+        return mark_simd::totals_avx2(m, out);
+    }
+    if (level == SimdLevel::SSE41)
+    {
+        return mark_simd::totals_sse41(m, out);
+    }
+#endif
+    (void)level;
+    mark_simd::totals_scalar(m, 0, out);
+}
+
+// out[i] = student i's total as a percentage of max_total
+inline void student_percentages(const MarkColumns& m, float* out, int max_total = 400,
+                                SimdLevel level = detect_simd())
+{
+#ifdef MARKKERNELS_X86
+    if (level == SimdLevel::AVX2)
+    {
+        return mark_simd::percentages_avx2(m, out, max_total);
+    }
+    if (level == SimdLevel::SSE41)
+    {
+        return mark_simd::percentages_sse41(m, out, max_total);
+    }
+#endif
+    (void)level;
+    mark_simd::percentages_scalar(m, 0, out, max_total);
+}
+
+inline ColumnStats column_stats(const int* col, size_t n, SimdLevel level = detect_simd())
+{
+    ColumnStats s;
+    if (n == 0)
+    {
+        return s;
+    }
+    s.n = n;
+    s.min = INT_MAX;
+    s.max = INT_MIN;
+#ifdef MARKKERNELS_X86
+    if (level == SimdLevel::AVX2)
+    {
+        mark_simd::stats_avx2(col, n, s);
+        return s;
+    }
+    if (level == SimdLevel::SSE41)
+    {
+        mark_simd::stats_sse41(col, n, s);
+        return s;
+    }
+#endif
+    (void)level;
+    mark_simd::stats_scalar(col, 0, n, s);
+    return s;
+}
+
+#endif
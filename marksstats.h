@@ -0,0 +1,259 @@
+// Exact statistics over integer marks.
+//
+// Marks and totals are small integers, so a MarkDistribution counts how
+// often each value occurs (values outside 0..range go to a short side
+// list) and answers everything from the counts: sum and sum of squares are
+// exact integers, so the mean and the variance are each rounded once, at
+// the final division, rather than accumulating error per value the way a
+// running floating-point sum does; percentiles come from the cumulative
+// counts without sorting. Building it is one pass and one increment per
+// value. class_statistics() fills one per mark column plus one over the
+// totals in a single pass over the registry's columns.
+#ifndef MARKSSTATS_H
+#define MARKSSTATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "markkernels.h"
+
+// total as a percentage of max_total, in floating point: (total / 300) * 100
+// in int truncates to 0 for every total under 300
+inline double mark_percentage(long long total, long long max_total)
+{
+    return max_total ? (double)total * 100.0 / (double)max_total : 0.0;
+}
+
+// n * sum(x^2) - sum(x)^2 over n^2, with the numerator exact
+inline double exact_variance(unsigned __int128 n, __int128 sum, unsigned __int128 sum_squares)
+{
+    if (n == 0)
+    {
+        return 0.0;
+    }
+    __int128 numerator = (__int128)(n * sum_squares) - sum * sum;
+    return (double)numerator / ((double)n * (double)n);
+}
+
+// one student's marks taken together
+struct MarkSummary
+{
+    int total = 0;
+    double percent = 0;   // of 100 per mark
+    double mean = 0;
+    double variance = 0;  // spread across the subjects
+};
+
+inline MarkSummary summarize_marks(const int* marks, int n, int max_mark = 100)
+{
+    MarkSummary s;
+    long long sum = 0;
+    unsigned __int128 sum_squares = 0;
+    for (int i = 0; i < n; i++)
+    {
+        sum += marks[i];
+        sum_squares += (unsigned __int128)((long long)marks[i] * marks[i]);
+    }
+    s.total = (int)sum;
+    s.percent = mark_percentage(sum, (long long)n * max_mark);
+    s.mean = n ? (double)sum / n : 0.0;
+    s.variance = exact_variance((unsigned)n, sum, sum_squares);
+    return s;
+}
+
+class MarkDistribution
+{
+public:
+    // values 0..range are counted directly
+    explicit MarkDistribution(int range = 100) : counts((size_t)range + 1, 0) {}
+
+    void add(int v)
+    {
+        if ((unsigned)v < counts.size())
+        {
+            counts[(unsigned)v]++;
+        }
+        else
+        {
+            outliers.push_back(v);
+        }
+        n++;
+        summarized = false;
+    }
+
+    void clear()
+    {
+        std::fill(counts.begin(), counts.end(), 0);
+        outliers.clear();
+        n = 0;
+        summarized = false;
+    }
+
+    size_t count() const
+    {
+        return n;
+    }
+
+    long long sum() const
+    {
+        summarize();
+        return (long long)total;
+    }
+
+    int min() const
+    {
+        summarize();
+        return low;
+    }
+
+    int max() const
+    {
+        summarize();
+        return high;
+    }
+
+    double mean() const
+    {
+        return n ? (double)sum() / (double)n : 0.0;
+    }
+
+    // population variance
+    double variance() const
+    {
+        summarize();
+        return exact_variance(n, total, total_squares);
+    }
+
+    double stddev() const
+    {
+        return std::sqrt(variance());
+    }
+
+    // nearest-rank percentile, p in [0, 100]: the smallest value with at
+    // least p% of the values at or below it
+    int percentile(double p) const
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+        summarize();
+        size_t rank = (size_t)std::ceil(p / 100.0 * (double)n);
+        rank = std::min(std::max(rank, (size_t)1), n);
+        // outliers are sorted: the negative ones first, then the large ones
+        size_t below = (size_t)(std::lower_bound(outliers.begin(), outliers.end(), 0) - outliers.begin());
+        if (rank <= below)
+        {
+            return outliers[rank - 1];
+        }
+        rank -= below;
+        for (size_t v = 0; v < counts.size(); v++)
+        {
+            if (rank <= counts[v])
+            {
+                return (int)v;
+            }
+            rank -= counts[v];
+        }
+        return outliers[below + rank - 1];
+    }
+
+private:
+    std::vector<uint64_t> counts;
+    mutable std::vector<int> outliers;
+    size_t n = 0;
+
+    // derived from counts and outliers on the first query after a change
+    mutable bool summarized = false;
+    mutable __int128 total = 0;
+    mutable unsigned __int128 total_squares = 0;
+    mutable int low = 0;
+    mutable int high = 0;
+
+    void summarize() const
+    {
+        if (summarized)
+        {
+            return;
+        }
+        std::sort(outliers.begin(), outliers.end());
+        total = 0;
+        total_squares = 0;
+        for (size_t v = 0; v < counts.size(); v++)
+        {
+            total += (__int128)(v * counts[v]);
+            total_squares += (unsigned __int128)(v * v) * counts[v];
+        }
+        for (int v : outliers)
+        {
+            total += v;
+            total_squares += (unsigned __int128)((long long)v * v);
+        }
+        low = high = 0;
+        if (n)
+        {
+            size_t first = 0, last = counts.size();
+            while (first < counts.size() && counts[first] == 0)
+            {
+                first++;
+            }
+            while (last > 0 && counts[last - 1] == 0)
+            {
+                last--;
+            }
+            bool any_outliers = !outliers.empty();
+            low = any_outliers && (outliers.front() < 0 || first == counts.size()) ? outliers.front() : (int)first;
+            high = any_outliers && (outliers.back() >= 0 || last == 0) ? outliers.back() : (int)last - 1;
+        }
+        summarized = true;
+    }
+};
+
+struct ClassStatistics
+{
+    MarkDistribution marks[4] = {MarkDistribution(100), MarkDistribution(100), MarkDistribution(100),
+                                 MarkDistribution(100)};
+    MarkDistribution totals = MarkDistribution(400);
+    int max_total = 400;
+
+    size_t count() const
+    {
+        return totals.count();
+    }
+
+    // the class's percentages, from the totals
+    double mean_percent() const
+    {
+        return totals.mean() * 100.0 / max_total;
+    }
+
+    double percentile_percent(double p) const
+    {
+        return mark_percentage(totals.percentile(p), max_total);
+    }
+};
+
+// every distribution in one pass over the columns
+inline void class_statistics(const MarkColumns& m, ClassStatistics& out, int max_total = 400)
+{
+    for (MarkDistribution& d : out.marks)
+    {
+        d.clear();
+    }
+    out.totals.clear();
+    out.max_total = max_total;
+    for (size_t i = 0; i < m.n; i++)
+    {
+        int a = m.col[0][i], b = m.col[1][i], c = m.col[2][i], d = m.col[3][i];
+        out.marks[0].add(a);
+        out.marks[1].add(b);
+        out.marks[2].add(c);
+        out.marks[3].add(d);
+        out.totals.add(a + b + c + d);
+    }
+}
+
+#endif
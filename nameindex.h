@@ -0,0 +1,296 @@
+// Ordered secondary index on student names.
+//
+// Keeps (name, roll_no) pairs in a balanced tree so add, rename and delete
+// are O(log n), and prefix or range queries cost O(log n + k) for k
+// matches. Names compare byte-wise, so the order is case-sensitive.
+//
+// The index holds no copies of the names: each entry is a NameRef into
+// the registry's NamePool, and the tree's nodes are carved from slabs of
+// a NodeArena, so indexing a record costs no heap allocation of its own.
+// Compacting the pool moves every name, so the owner calls rebind()
+// afterwards to point the entries at the new offsets.
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <new>
+#include <set>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "namepool.h"
+
+// fixed-size blocks from 64 KB slabs, with freed blocks kept on a list
+// for reuse; every block handed out must have the same size
+class NodeArena
+{
+public:
+    NodeArena() = default;
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    ~NodeArena()
+    {
+        release();
+    }
+
+    void* allocate(size_t size)
+    {
+        if (free_list)
+        {
+            FreeBlock* block = free_list;
+            free_list = block->next;
+            return block;
+        }
+        size = std::max(size, sizeof(FreeBlock));
+        size = (size + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+        if (slabs.empty() || used + size > slab_bytes)
+        {
+            slabs.push_back(::operator new(slab_bytes));
+            used = 0;
+        }
+        void* p = static_cast<char*>(slabs.back()) + used;
+        used += size;
+        return p;
+    }
+
+    void deallocate(void* p)
+    {
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        block->next = free_list;
+        free_list = block;
+    }
+
+    // frees every slab; no block may still be in use
+    void release()
+    {
+        for (void* slab : slabs)
+        {
+            ::operator delete(slab);
+        }
+        slabs.clear();
+        used = 0;
+        free_list = nullptr;
+    }
+
+private:
+    static const size_t slab_bytes = 64 * 1024;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    std::vector<void*> slabs;
+    size_t used = 0;
+    FreeBlock* free_list = nullptr;
+};
+
+// single objects from a NodeArena, anything larger from the heap
+template <class T>
+class NodeAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit NodeAllocator(NodeArena* arena) : arena(arena) {}
+
+    template <class U>
+    NodeAllocator(const NodeAllocator<U>& other) : arena(other.arena)
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(n == 1 ? arena->allocate(sizeof(T)) : ::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        if (n == 1)
+        {
+            arena->deallocate(p);
+        }
+        else
+        {
+            ::operator delete(p);
+        }
+    }
+
+    template <class U>
+    bool operator==(const NodeAllocator<U>& other) const
+    {
+        return arena == other.arena;
+    }
+
+    template <class U>
+    bool operator!=(const NodeAllocator<U>& other) const
+    {
+        return arena != other.arena;
+    }
+
+private:
+    template <class U>
+    friend class NodeAllocator;
+
+    NodeArena* arena;
+};
+
+class NameIndex
+{
+public:
+    // names are read from pool, which must outlive the index
+    explicit NameIndex(const NamePool& pool) : pool(pool), entries(KeyLess{&pool}, NodeAllocator<Entry>(&arena)) {}
+
+    NameIndex(const NameIndex&) = delete;
+    NameIndex& operator=(const NameIndex&) = delete;
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    void clear()
+    {
+        entries.clear();
+        arena.release();
+    }
+
+    // rebuilds from (name, roll_no) pairs in any order: one sort, then
+    // hinted appends, much cheaper than n independent inserts
+    void assign(std::vector<std::pair<NameRef, int>>& pairs)
+    {
+        KeyLess less{&pool};
+        std::sort(pairs.begin(), pairs.end(), [&](const std::pair<NameRef, int>& a, const std::pair<NameRef, int>& b)
+        {
+            return less(Entry{a.first, a.second}, Entry{b.first, b.second});
+        });
+        clear();
+        for (const auto& p : pairs)
+        {
+            entries.emplace_hint(entries.end(), Entry{p.first, p.second});
+        }
+    }
+
+    void insert(NameRef name, int roll_no)
+    {
+        entries.insert(Entry{name, roll_no});
+    }
+
+    void erase(std::string_view name, int roll_no)
+    {
+        auto it = entries.find(Probe(name, roll_no));
+        if (it != entries.end())
+        {
+            entries.erase(it);
+        }
+    }
+
+    // points every entry at its name's new place after the pool was
+    // compacted: ref_of(roll_no) returns the student's current NameRef
+    template <class F>
+    void rebind(F ref_of)
+    {
+        for (const Entry& e : entries)
+        {
+            e.name = ref_of(e.roll_no);
+        }
+    }
+
+    // f(name, roll_no) for every name starting with prefix, in name order;
+    // stops after limit matches (0 = no limit). Returns the match count.
+    template <class F>
+    size_t prefix(std::string_view prefix, F f, size_t limit = 0) const
+    {
+        size_t found = 0;
+        for (auto it = entries.lower_bound(Probe(prefix, INT_MIN)); it != entries.end(); ++it)
+        {
+            std::string_view name = pool.view(it->name);
+            if (name.compare(0, prefix.size(), prefix) != 0)
+            {
+                break;
+            }
+            f(name, it->roll_no);
+            if (++found == limit)
+            {
+                break;
+            }
+        }
+        return found;
+    }
+
+    // f(name, roll_no) for every name in [low, high), in name order
+    template <class F>
+    size_t range(std::string_view low, std::string_view high, F f, size_t limit = 0) const
+    {
+        size_t found = 0;
+        for (auto it = entries.lower_bound(Probe(low, INT_MIN)); it != entries.end(); ++it)
+        {
+            std::string_view name = pool.view(it->name);
+            if (name >= high)
+            {
+                break;
+            }
+            f(name, it->roll_no);
+            if (++found == limit)
+            {
+                break;
+            }
+        }
+        return found;
+    }
+
+private:
+    struct Entry
+    {
+        // rebinding keeps the same bytes, so the order does not change
+        mutable NameRef name;
+        int roll_no;
+    };
+
+    typedef std::pair<std::string_view, int> Probe;
+
+    // orders by name then roll_no; transparent so lookups need no copy
+    struct KeyLess
+    {
+        typedef void is_transparent;
+
+        const NamePool* pool;
+
+        std::string_view name(const Entry& e) const
+        {
+            return pool->view(e.name);
+        }
+
+        std::string_view name(const Probe& p) const
+        {
+            return p.first;
+        }
+
+        static int roll(const Entry& e)
+        {
+            return e.roll_no;
+        }
+
+        static int roll(const Probe& p)
+        {
+            return p.second;
+        }
+
+        template <class A, class B>
+        bool operator()(const A& a, const B& b) const
+        {
+            int c = name(a).compare(name(b));
+            return c < 0 || (c == 0 && roll(a) < roll(b));
+        }
+    };
+
+    const NamePool& pool;
+    NodeArena arena;
+    std::set<Entry, KeyLess, NodeAllocator<Entry>> entries;
+};
+
+#endif
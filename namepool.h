@@ -0,0 +1,120 @@
+// Arena for student names.
+//
+// Names are appended back to back into one growing byte buffer and
+// records keep a NameRef (offset, length) into it, so loading a million
+// students costs a few dozen buffer growths instead of a heap allocation
+// per name. Renames and deletes only leave dead bytes behind; the owner
+// reclaims them all at once with compact(), which copies the live names
+// into a fresh buffer in the order it is given. Offsets are 32-bit, so
+// one pool holds up to 4 GB of names; append() refuses a name that would
+// pass that rather than let the offsets wrap.
+#ifndef NAMEPOOL_H
+#define NAMEPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+struct NameRef
+{
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+class NamePool
+{
+public:
+    // the largest buffer a 32-bit NameRef can address
+    static const size_t max_bytes = UINT32_MAX;
+
+    // bytes in the buffer, dead ones included
+    size_t bytes() const
+    {
+        return data.size();
+    }
+
+    // bytes no NameRef points at any more
+    size_t dead_bytes() const
+    {
+        return dead;
+    }
+
+    void reserve(size_t n)
+    {
+        data.reserve(n);
+    }
+
+    void clear()
+    {
+        data.clear();
+        dead = 0;
+    }
+
+    void shrink_to_fit()
+    {
+        data.shrink_to_fit();
+    }
+
+    std::string_view view(NameRef ref) const
+    {
+        return std::string_view(data.data() + ref.offset, ref.length);
+    }
+
+    // whether n more bytes can be appended
+    bool fits(size_t n) const
+    {
+        return n <= max_bytes - data.size();
+    }
+
+    // sets ref to a copy of name at the end of the buffer; false, leaving
+    // the pool as it was, if that would pass max_bytes
+    bool append(std::string_view name, NameRef& ref)
+    {
+        if (!fits(name.size()))
+        {
+            return false;
+        }
+        ref = NameRef{(uint32_t)data.size(), (uint32_t)name.size()};
+        const char* p = name.data();
+        // name may point into this pool, which the insert can move
+        if (!data.empty() && p >= data.data() && p < data.data() + data.size())
+        {
+            size_t from = (size_t)(p - data.data());
+            data.resize(data.size() + name.size());
+            std::copy(data.begin() + from, data.begin() + from + name.size(), data.begin() + ref.offset);
+            return true;
+        }
+        data.insert(data.end(), p, p + name.size());
+        return true;
+    }
+
+    // marks a name's bytes as garbage
+    void release(NameRef ref)
+    {
+        dead += ref.length;
+    }
+
+    // rewrites the buffer to hold only the names in refs, in that order,
+    // and updates refs to match
+    void compact(std::vector<NameRef>& refs)
+    {
+        std::vector<char> fresh;
+        fresh.reserve(data.size() - dead);
+        for (NameRef& ref : refs)
+        {
+            uint32_t offset = (uint32_t)fresh.size();
+            fresh.insert(fresh.end(), data.begin() + ref.offset, data.begin() + ref.offset + ref.length);
+            ref.offset = offset;
+        }
+        data.swap(fresh);
+        dead = 0;
+    }
+
+private:
+    std::vector<char> data;
+    size_t dead = 0;
+};
+
+#endif
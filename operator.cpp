@@ -11,21 +11,143 @@ here the link and see the operators in symbol.
 https://media.geeksforgeeks.org/wp-content/uploads/20220527101351/OperatorsinCPP.png, */
 
 #include <iostream>
+#include "batchcalc.h"
+#include "bigint.h"
+#include "demos.h"
+#include "marksstats.h"
 using namespace std;
-int main()
+
+// operator --batch [--family arithmetic|relational|logical|bitwise|all]
+//                  [--input FILE | --generate N] [--output FILE] [--format csv|bin]
+// applies the operators below to every pair of two whole columns at once
+static int run_batch(int argc, char** argv)
+{
+     CalcFamilies families = calc_all_families;
+     string input_path, output_path = "-";
+     size_t generate = 0;
+     bool binary = false;
+     for (int i = 1; i < argc; i++)
+     {
+          string arg = argv[i];
+          if (arg == "--batch")
+          {
+               continue;
+          }
+          else if (arg == "--family" && i + 1 < argc)
+          {
+               if (!parse_calc_family(argv[++i], families))
+               {
+                    cerr << "Unknown family " << argv[i] << " (use arithmetic, relational, logical, bitwise or all)\n";
+                    return 2;
+               }
+          }
+          else if (arg == "--input" && i + 1 < argc)
+          {
+               input_path = argv[++i];
+          }
+          else if (arg == "--generate" && i + 1 < argc)
+          {
+               generate = strtoull(argv[++i], nullptr, 10);
+          }
+          else if (arg == "--output" && i + 1 < argc)
+          {
+               output_path = argv[++i];
+          }
+          else if (arg == "--format" && i + 1 < argc)
+          {
+               string format = argv[++i];
+               if (format != "csv" && format != "bin")
+               {
+                    cerr << "Unknown format " << format << " (use csv or bin)\n";
+                    return 2;
+               }
+               binary = format == "bin";
+          }
+          else
+          {
+               cerr << "usage: " << argv[0] << " --batch [--family NAME] [--input FILE | --generate N]"
+                    << " [--output FILE] [--format csv|bin]\n";
+               return 2;
+          }
+     }
+
+     CalcTable table;
+     string error;
+     if (!input_path.empty())
+     {
+          string data;
+          if (!read_input(input_path, data, error) || !calc_parse_input(data, table, error))
+          {
+               cerr << error << "\n";
+               return 1;
+          }
+     }
+     else
+     {
+          calc_generate(table, generate);
+     }
+     calc_run(table, families);
+
+     int fd = output_path == "-" ? STDOUT_FILENO : ::open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+     bool ok = fd >= 0 && (binary ? calc_write_binary(fd, table) : calc_write_csv(fd, table));
+     if (fd > STDOUT_FILENO)
+     {
+          ok = ::close(fd) == 0 && ok;
+     }
+     if (!ok)
+     {
+          cerr << "cannot write " << output_path << ": " << strerror(errno) << "\n";
+          return 1;
+     }
+     cerr << table.rows() << " rows, " << table.ops.size() << " operators, " << table.invalid
+          << " divisions by zero\n";
+     return 0;
+}
+
+static void operator_demos();
+
+// calc: the calculator below; calc --operators: the demonstrations after
+// it; calc --batch ...: run_batch above
+int calc_main(int argc, char** argv)
 {
-     int n, m, z;
+     if (argc > 1 && string(argv[1]) == "--operators")
+     {
+          operator_demos();
+          return 0;
+     }
+     if (argc > 1)
+     {
+          return run_batch(argc, argv);
+     }
+
+     // BigInt instead of int, so n * m never overflows and any number of digits works
+     string first, second;
+     BigInt n, m;
      cout << "Enter the first number: ";
-     cin >> n;
+     cin >> first;
      cout << "Enter the second number: ";
-     cin >> m;
+     cin >> second;
+     if (!BigInt::parse(first, n) || !BigInt::parse(second, m))
+     {
+          cout << "Please enter whole numbers." << endl;
+          return 1;
+     }
 
      // Arithmatic Operators
-     cout << "Addition: " << n + m << endl;
-     cout << "Subtraction: " << n - m << endl;
-     cout << "Multiplication: " << n * m << endl;
-     cout << "Division: " << n / m << endl;
-     cout << "Modulus: " << n % m << endl;
+     cout << "Addition: " << (n + m).to_string() << endl;
+     cout << "Subtraction: " << (n - m).to_string() << endl;
+     cout << "Multiplication: " << (n * m).to_string() << endl;
+     BigInt quotient, remainder;
+     if (BigInt::divmod(n, m, quotient, remainder))
+     {
+          cout << "Division: " << quotient.to_string() << endl;
+          cout << "Modulus: " << remainder.to_string() << endl;
+     }
+     else
+     {
+          cout << "Division: undefined (division by zero)" << endl;
+          cout << "Modulus: undefined (division by zero)" << endl;
+     }
 
      // here the some demostration or we say that use of arithmatic operators.
      int mark1, mark2, mark3;
@@ -39,17 +161,15 @@ int main()
      int total = mark1 + mark2 + mark3;
      cout << "The total mark of student is: " << total << endl;
 
-     float percent;
-     percent = (total / 300) * 100;
+     // total / 300 in int division is 0 for any total under 300
+     double percent = mark_percentage(total, 300);
      cout << "The percentage of student is: " << percent << "%" << endl;
 
      return 0;
 }
 
 // here the demostration of Relational operator
-#include <iostream>
-using namespace std;
-int main()
+static void relational_operators()
 {
      int a = 6, b = 4;
 
@@ -70,15 +190,10 @@ int main()
 
      // true
      cout << "a != b is " << (a != b) << endl;
-
-     return 0;
 }
 
 // Here the demoastration of logical operator
-#include <iostream>
-using namespace std;
-
-int main()
+static void logical_operators()
 {
     int a = 6, b = 4;
 
@@ -90,15 +205,10 @@ int main()
   
     // Logical NOT operator
     cout << "!b is " << (!b) << endl;
-
-    return 0;
 }
 
 // here the demonstration of bitwise operator
-#include <iostream>
-using namespace std;
-
-int main()
+static void bitwise_operators()
 {
     int a = 6, b = 4;
 
@@ -119,15 +229,10 @@ int main()
 
     // One’s Complement operator
     cout << "~(a) is " << ~(a) << endl;
-
-    return 0;
 }
 
 // here the demonstration of assignment operator
-#include <iostream>
-using namespace std;
-
-int main()
+static void assignment_operators()
 {
     int a = 6, b = 4;
 
@@ -145,24 +250,33 @@ int main()
   
     //  Divide and Assignment Operator
     cout << "a /= b is " << (a /= b) << endl;
-
-    return 0;
 }
 
 // here the demonstration of ternary or conditional operator
-#include <iostream>
-using namespace std;
-
-int main()
+static void ternary_operator()
 {
     int a = 3, b = 4;
 
     // Conditional Operator
     int result = (a < b) ? b : a;
     cout << "The greatest number is " << result << endl;
+}
 
-    return 0;
+static void operator_demos()
+{
+     relational_operators();
+     logical_operators();
+     bitwise_operators();
+     assignment_operators();
+     ternary_operator();
+}
+
+#ifndef DEMOS_NO_MAIN
+int main(int argc, char** argv)
+{
+     return calc_main(argc, argv);
 }
+#endif
 
 /* here the overall concept of operator
 https://www.geeksforgeeks.org/operators-in-cpp/?ref=lbp
@@ -1,10 +1,19 @@
 #include<iostream>
+#include"demos.h"
 using namespace std;
-int main()
+int number_main(int, char**)
 {
     int n;
     cout<<"Enter the number: ";
     cin>>n;
 
-    cout<<endl<<"Number is added: "<<n;
-}
\ No newline at end of file
+    cout<<endl<<"Number is added: "<<n<<endl;
+    return 0;
+}
+
+#ifndef DEMOS_NO_MAIN
+int main(int argc, char** argv)
+{
+    return number_main(argc, argv);
+}
+#endif
@@ -0,0 +1,288 @@
+// Order-statistics tree over student totals.
+//
+// A treap keyed by (total descending, roll_no ascending) whose nodes carry
+// subtree sizes, so insert, erase, rank and k-th lookups are O(log n)
+// expected and the top k come out in O(log n + k). Nodes live in one
+// vector and are linked by index, with a free list for reuse.
+#ifndef RANKTREE_H
+#define RANKTREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class RankTree
+{
+public:
+    size_t size() const
+    {
+        return root < 0 ? 0 : nodes[root].size;
+    }
+
+    void clear()
+    {
+        nodes.clear();
+        free_nodes.clear();
+        root = -1;
+    }
+
+    void insert(int total, int roll_no)
+    {
+        int32_t n = new_node(total, roll_no);
+        int32_t left, right;
+        split(root, total, roll_no, left, right);
+        root = merge(merge(left, n), right);
+    }
+
+    bool erase(int total, int roll_no)
+    {
+        int32_t* link = &root;
+        while (*link >= 0)
+        {
+            Node& node = nodes[*link];
+            if (node.total == total && node.roll_no == roll_no)
+            {
+                int32_t gone = *link;
+                *link = merge(node.left, node.right);
+                free_nodes.push_back(gone);
+                // walk the path again to fix the sizes above the hole
+                for (int32_t t = root; t >= 0 && t != *link;)
+                {
+                    nodes[t].size--;
+                    t = before(total, roll_no, nodes[t].total, nodes[t].roll_no) ? nodes[t].left
+                                                                                  : nodes[t].right;
+                }
+                return true;
+            }
+            link = before(total, roll_no, node.total, node.roll_no) ? &node.left : &node.right;
+        }
+        return false;
+    }
+
+    // number of entries with a strictly higher total
+    size_t count_above(int total) const
+    {
+        size_t count = 0;
+        int32_t t = root;
+        while (t >= 0)
+        {
+            const Node& node = nodes[t];
+            if (node.total > total)
+            {
+                count += subtree(node.left) + 1;
+                t = node.right;
+            }
+            else
+            {
+                t = node.left;
+            }
+        }
+        return count;
+    }
+
+    // the k-th entry (0-based) in descending-total order
+    bool kth(size_t k, int& total, int& roll_no) const
+    {
+        int32_t t = root;
+        while (t >= 0)
+        {
+            const Node& node = nodes[t];
+            size_t left = subtree(node.left);
+            if (k < left)
+            {
+                t = node.left;
+            }
+            else if (k == left)
+            {
+                total = node.total;
+                roll_no = node.roll_no;
+                return true;
+            }
+            else
+            {
+                k -= left + 1;
+                t = node.right;
+            }
+        }
+        return false;
+    }
+
+    // f(total, roll_no) for the first k entries, highest total first
+    template <class F>
+    void top(size_t k, F f) const
+    {
+        std::vector<int32_t> stack;
+        int32_t t = root;
+        while (k > 0 && (t >= 0 || !stack.empty()))
+        {
+            while (t >= 0)
+            {
+                stack.push_back(t);
+                t = nodes[t].left;
+            }
+            t = stack.back();
+            stack.pop_back();
+            f(nodes[t].total, nodes[t].roll_no);
+            k--;
+            t = nodes[t].right;
+        }
+    }
+
+    // rebuilds from (total, roll_no) pairs in any order in O(n log n) with
+    // a sort, instead of n separate inserts
+    void assign(std::vector<std::pair<int, int>>& items)
+    {
+        clear();
+        std::sort(items.begin(), items.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b)
+        {
+            return before(a.first, a.second, b.first, b.second);
+        });
+        nodes.reserve(items.size());
+        for (const std::pair<int, int>& it : items)
+        {
+            new_node(it.first, it.second);
+        }
+        root = build(0, (int32_t)items.size());
+        // hand out random priorities in heap order: level by level from the
+        // root, largest first
+        std::vector<uint32_t> prios(items.size());
+        for (uint32_t& p : prios)
+        {
+            p = next_priority();
+        }
+        std::sort(prios.begin(), prios.end(), [](uint32_t a, uint32_t b) { return a > b; });
+        std::vector<int32_t> level;
+        if (root >= 0)
+        {
+            level.push_back(root);
+        }
+        size_t next = 0;
+        for (size_t head = 0; head < level.size(); head++)
+        {
+            Node& node = nodes[level[head]];
+            node.prio = prios[next++];
+            if (node.left >= 0)
+            {
+                level.push_back(node.left);
+            }
+            if (node.right >= 0)
+            {
+                level.push_back(node.right);
+            }
+        }
+    }
+
+private:
+    struct Node
+    {
+        int total;
+        int roll_no;
+        uint32_t prio;
+        uint32_t size;
+        int32_t left;
+        int32_t right;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int32_t> free_nodes;
+    int32_t root = -1;
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+
+    // order of the tree: higher total first, then lower roll_no
+    static bool before(int a_total, int a_roll, int b_total, int b_roll)
+    {
+        return a_total > b_total || (a_total == b_total && a_roll < b_roll);
+    }
+
+    size_t subtree(int32_t t) const
+    {
+        return t < 0 ? 0 : nodes[t].size;
+    }
+
+    void fix(int32_t t)
+    {
+        nodes[t].size = (uint32_t)(1 + subtree(nodes[t].left) + subtree(nodes[t].right));
+    }
+
+    uint32_t next_priority()
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return (uint32_t)(seed >> 32);
+    }
+
+    int32_t new_node(int total, int roll_no)
+    {
+        Node node{total, roll_no, next_priority(), 1, -1, -1};
+        if (!free_nodes.empty())
+        {
+            int32_t n = free_nodes.back();
+            free_nodes.pop_back();
+            nodes[n] = node;
+            return n;
+        }
+        nodes.push_back(node);
+        return (int32_t)nodes.size() - 1;
+    }
+
+    // left gets the keys ordered before (total, roll_no), right the rest
+    void split(int32_t t, int total, int roll_no, int32_t& left, int32_t& right)
+    {
+        if (t < 0)
+        {
+            left = right = -1;
+            return;
+        }
+        if (before(nodes[t].total, nodes[t].roll_no, total, roll_no))
+        {
+            split(nodes[t].right, total, roll_no, nodes[t].right, right);
+            left = t;
+        }
+        else
+        {
+            split(nodes[t].left, total, roll_no, left, nodes[t].left);
+            right = t;
+        }
+        fix(t);
+    }
+
+    int32_t merge(int32_t a, int32_t b)
+    {
+        if (a < 0)
+        {
+            return b;
+        }
+        if (b < 0)
+        {
+            return a;
+        }
+        if (nodes[a].prio > nodes[b].prio)
+        {
+            nodes[a].right = merge(nodes[a].right, b);
+            fix(a);
+            return a;
+        }
+        nodes[b].left = merge(a, nodes[b].left);
+        fix(b);
+        return b;
+    }
+
+    // balanced tree over nodes [lo, hi), which are already in key order
+    int32_t build(int32_t lo, int32_t hi)
+    {
+        if (lo >= hi)
+        {
+            return -1;
+        }
+        int32_t mid = lo + (hi - lo) / 2;
+        nodes[mid].left = build(lo, mid);
+        nodes[mid].right = build(mid + 1, hi);
+        fix(mid);
+        return mid;
+    }
+};
+
+#endif
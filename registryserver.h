@@ -0,0 +1,666 @@
+// Serves a StudentRegistry over a Unix domain socket, for studentrecord
+// --serve: other processes can add, get, update, delete and ask for the
+// top k students without starting a process per lookup.
+//
+// One thread runs an epoll loop over the listening socket and every
+// connection, all non-blocking. A client may pipeline: it can send any
+// number of requests without waiting, and the server answers each
+// connection's requests in order. Everything that arrives in one read is
+// handled before replying, and the replies go out together in one send,
+// so a deep pipeline costs a couple of system calls per batch instead of
+// two per request. A connection whose replies back up past
+// max_pending_out is not read again until they drain. When the process
+// runs out of descriptors, a spare one kept open for the purpose is freed
+// to accept and close each waiting connection, so the level-triggered
+// listener does not keep the loop spinning; if even that fails, the
+// listener is taken out of the loop until a connection closes or the
+// loop is idle for a timeout.
+//
+// Protocol. Every message is a frame, in host byte order (the socket is
+// local):
+//   u32 size    bytes after this field
+//   u8  op      a ServerOp in requests, a ServerStatus in replies
+//   u32 tag     chosen by the client and echoed in the reply
+//   payload
+// Request payloads:
+//   Add, Update   i32 roll_no, i32 marks[4], u16 name length, name bytes
+//   Get, Delete   i32 roll_no
+//   Top           u32 k, at most server_max_top
+// A reply to Get that found the student carries the record in the Add
+// layout. A reply to Top carries u32 count and then count pairs of i32
+// roll_no, i32 total, best first. Other replies have no payload. A frame
+// larger than server_max_frame closes the connection. Any other bad
+// request gets a BadRequest reply, as does an Add or Update whose name no
+// longer fits in the registry (4 GB of names in all).
+#ifndef REGISTRYSERVER_H
+#define REGISTRYSERVER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "student.h"
+#include "studentregistry.h"
+#include "wal.h"
+
+enum class ServerOp : uint8_t
+{
+    Add = 1,
+    Get,
+    Update,
+    Delete,
+    Top
+};
+
+enum class ServerStatus : uint8_t
+{
+    Ok = 0,
+    NotFound,
+    Exists,
+    BadRequest
+};
+
+const size_t server_frame_header = 9;  // size, op, tag
+const size_t server_max_frame = 64 * 1024;
+const uint32_t server_max_top = 4096;
+
+namespace server_wire
+{
+
+inline void put_u32(std::string& out, uint32_t v)
+{
+    out.append((const char*)&v, sizeof(v));
+}
+
+inline uint32_t get_u32(const char* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// size, op and tag; the size is patched by end_frame
+inline size_t begin_frame(std::string& out, uint8_t op, uint32_t tag)
+{
+    size_t start = out.size();
+    put_u32(out, 0);
+    out += (char)op;
+    put_u32(out, tag);
+    return start;
+}
+
+inline void end_frame(std::string& out, size_t start)
+{
+    uint32_t size = (uint32_t)(out.size() - start - sizeof(uint32_t));
+    std::memcpy(&out[start], &size, sizeof(size));
+}
+
+// name length is cut to what a u16 holds
+inline void put_record(std::string& out, int roll_no, const int* marks, std::string_view name)
+{
+    put_u32(out, (uint32_t)roll_no);
+    for (int k = 0; k < 4; k++)
+    {
+        put_u32(out, (uint32_t)marks[k]);
+    }
+    uint16_t length = (uint16_t)std::min<size_t>(name.size(), UINT16_MAX);
+    out.append((const char*)&length, sizeof(length));
+    out.append(name.data(), length);
+}
+
+// false unless payload is exactly one record
+inline bool get_record(std::string_view payload, int& roll_no, int* marks, std::string_view& name)
+{
+    if (payload.size() < 22)
+    {
+        return false;
+    }
+    roll_no = (int)get_u32(payload.data());
+    for (int k = 0; k < 4; k++)
+    {
+        marks[k] = (int)get_u32(payload.data() + 4 + 4 * k);
+    }
+    uint16_t length;
+    std::memcpy(&length, payload.data() + 20, sizeof(length));
+    if (payload.size() != 22u + length)
+    {
+        return false;
+    }
+    name = payload.substr(22);
+    return true;
+}
+
+} // namespace server_wire
+
+// client side: appends one request frame to out
+inline void server_request(std::string& out, ServerOp op, uint32_t tag, int roll_no,
+                           const int* marks = nullptr, std::string_view name = std::string_view())
+{
+    size_t start = server_wire::begin_frame(out, (uint8_t)op, tag);
+    if (op == ServerOp::Add || op == ServerOp::Update)
+    {
+        server_wire::put_record(out, roll_no, marks, name);
+    }
+    else
+    {
+        server_wire::put_u32(out, (uint32_t)roll_no);
+    }
+    server_wire::end_frame(out, start);
+}
+
+inline void server_top_request(std::string& out, uint32_t tag, uint32_t k)
+{
+    size_t start = server_wire::begin_frame(out, (uint8_t)ServerOp::Top, tag);
+    server_wire::put_u32(out, k);
+    server_wire::end_frame(out, start);
+}
+
+struct ServerReply
+{
+    ServerStatus status;
+    uint32_t tag;
+    std::string_view payload;
+
+    // the student in a reply to Get
+    bool record(int& roll_no, int* marks, std::string_view& name) const
+    {
+        return server_wire::get_record(payload, roll_no, marks, name);
+    }
+
+    // f(roll_no, total) for each entry of a reply to Top; returns the count
+    template <class F>
+    size_t top(F f) const
+    {
+        if (payload.size() < 4)
+        {
+            return 0;
+        }
+        size_t count = std::min<size_t>(server_wire::get_u32(payload.data()), (payload.size() - 4) / 8);
+        for (size_t i = 0; i < count; i++)
+        {
+            const char* p = payload.data() + 4 + 8 * i;
+            f((int)server_wire::get_u32(p), (int)server_wire::get_u32(p + 4));
+        }
+        return count;
+    }
+};
+
+// parses the reply frame at the start of data and returns its size, or 0
+// if data does not hold a whole frame yet
+inline size_t server_parse_reply(std::string_view data, ServerReply& out)
+{
+    if (data.size() < server_frame_header)
+    {
+        return 0;
+    }
+    size_t size = server_wire::get_u32(data.data()) + sizeof(uint32_t);
+    if (size < server_frame_header || data.size() < size)
+    {
+        return 0;
+    }
+    out.status = (ServerStatus)data[4];
+    out.tag = server_wire::get_u32(data.data() + 5);
+    out.payload = data.substr(server_frame_header, size - server_frame_header);
+    return size;
+}
+
+class RegistryServer
+{
+public:
+    static const size_t max_pending_out = 1024 * 1024;
+
+    // on_change(op, roll_no, marks, name) runs after every change the
+    // server makes, e.g. to log it; a delete passes the removed record
+    typedef std::function<void(WalOp op, int roll_no, const int* marks, std::string_view name)> ChangeHook;
+
+    explicit RegistryServer(StudentRegistry& registry, ChangeHook on_change = nullptr)
+        : registry(registry), on_change(std::move(on_change))
+    {
+    }
+
+    RegistryServer(const RegistryServer&) = delete;
+    RegistryServer& operator=(const RegistryServer&) = delete;
+
+    ~RegistryServer()
+    {
+        for (std::unique_ptr<Connection>& c : connections)
+        {
+            if (c)
+            {
+                ::close(c->fd);
+            }
+        }
+        if (spare_fd >= 0)
+        {
+            ::close(spare_fd);
+        }
+        if (listen_fd >= 0)
+        {
+            ::close(listen_fd);
+            ::unlink(path.c_str());
+        }
+        if (epoll_fd >= 0)
+        {
+            ::close(epoll_fd);
+        }
+    }
+
+    // binds the socket, replacing a stale one left at path
+    bool listen(const std::string& socket_path, std::string& error)
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (socket_path.size() >= sizeof(addr.sun_path))
+        {
+            error = "socket path too long: " + socket_path;
+            return false;
+        }
+        std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+        epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+        listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (epoll_fd < 0 || listen_fd < 0)
+        {
+            error = std::string("cannot create socket: ") + std::strerror(errno);
+            return false;
+        }
+        ::unlink(socket_path.c_str());
+        if (::bind(listen_fd, (const sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listen_fd, 128) != 0)
+        {
+            error = "cannot listen on " + socket_path + ": " + std::strerror(errno);
+            ::close(listen_fd);
+            listen_fd = -1;
+            return false;
+        }
+        path = socket_path;
+        spare_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        set_listening(true);
+        return true;
+    }
+
+    // serves until stop is set (checked at least every 100 ms); false on
+    // an error of the event loop itself
+    bool run(const std::atomic<bool>& stop, std::string& error)
+    {
+        epoll_event events[64];
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            int n = ::epoll_wait(epoll_fd, events, 64, 100);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                error = std::string("epoll_wait: ") + std::strerror(errno);
+                return false;
+            }
+            if (n == 0 && !listening)
+            {
+                // paused at the descriptor limit with nothing to drop:
+                // try again at most once per idle timeout
+                set_listening(true);
+            }
+            for (int i = 0; i < n; i++)
+            {
+                if (events[i].data.fd == listen_fd)
+                {
+                    accept_all();
+                }
+                else if (Connection* c = connections[events[i].data.fd].get())
+                {
+                    serve(*c, events[i].events);
+                }
+            }
+        }
+        return true;
+    }
+
+    uint64_t requests_served() const
+    {
+        return requests;
+    }
+
+    size_t open_connections() const
+    {
+        return open;
+    }
+
+private:
+    struct Connection
+    {
+        explicit Connection(int fd) : fd(fd) {}
+
+        int fd;
+        uint32_t events = 0;
+        std::string in;
+        std::string out;
+        size_t out_sent = 0;
+        bool peer_closed = false;
+    };
+
+    StudentRegistry& registry;
+    ChangeHook on_change;
+    std::string path;
+    int epoll_fd = -1;
+    int listen_fd = -1;
+    int spare_fd = -1;        // given up to shed a connection at the fd limit
+    bool listening = false;   // listen_fd is in the epoll set
+    std::vector<std::unique_ptr<Connection>> connections;  // by fd
+    size_t open = 0;
+    uint64_t requests = 0;
+
+    void accept_all()
+    {
+        for (;;)
+        {
+            int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0 && (errno == EINTR || errno == ECONNABORTED))
+            {
+                continue;
+            }
+            if (fd < 0 && (errno == EMFILE || errno == ENFILE))
+            {
+                if (!shed_connection())
+                {
+                    return;
+                }
+                continue;
+            }
+            if (fd < 0)
+            {
+                // EAGAIN once the backlog is empty; anything else is the
+                // client's problem and the next connection may still work
+                return;
+            }
+            if ((size_t)fd >= connections.size())
+            {
+                connections.resize((size_t)fd + 1);
+            }
+            connections[fd].reset(new Connection(fd));
+            open++;
+            watch(*connections[fd], EPOLLIN);
+        }
+    }
+
+    // out of descriptors: accepts the oldest waiting connection on the
+    // spare fd and closes it at once. Without a spare, stops watching the
+    // listener until drop() frees a descriptor. False if nothing was shed.
+    bool shed_connection()
+    {
+        if (spare_fd >= 0)
+        {
+            ::close(spare_fd);
+            int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            int accept_error = errno;
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+            spare_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+            if (fd >= 0)
+            {
+                return true;
+            }
+            if (accept_error == EAGAIN || accept_error == EWOULDBLOCK)
+            {
+                return false;  // the backlog emptied meanwhile
+            }
+        }
+        set_listening(false);
+        return false;
+    }
+
+    void set_listening(bool on)
+    {
+        if (on == listening)
+        {
+            return;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = listen_fd;
+        ::epoll_ctl(epoll_fd, on ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, listen_fd, &ev);
+        listening = on;
+    }
+
+    void watch(Connection& c, uint32_t events)
+    {
+        if (events == c.events)
+        {
+            return;
+        }
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = c.fd;
+        ::epoll_ctl(epoll_fd, c.events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, c.fd, &ev);
+        c.events = events;
+    }
+
+    void drop(Connection& c)
+    {
+        int fd = c.fd;
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections[fd].reset();
+        open--;
+        if (!listening)
+        {
+            // a descriptor is free again: take the spare back first
+            if (spare_fd < 0)
+            {
+                spare_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+            }
+            set_listening(true);
+        }
+    }
+
+    void serve(Connection& c, uint32_t events)
+    {
+        if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        {
+            // take everything there is, up to the point the replies would
+            // back up anyway
+            char block[65536];
+            while (!c.peer_closed && c.in.size() < max_pending_out)
+            {
+                ssize_t got = ::read(c.fd, block, sizeof(block));
+                if (got > 0)
+                {
+                    c.in.append(block, (size_t)got);
+                    continue;
+                }
+                if (got < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (got < 0 && errno == EAGAIN)
+                {
+                    break;
+                }
+                c.peer_closed = true;
+            }
+        }
+        // answer and send in rounds: handling stops once the replies back
+        // up, and if they then all go out, whole requests may still be
+        // waiting in c.in with no further event coming to wake us
+        do
+        {
+            if (!handle_requests(c) || !send_replies(c))
+            {
+                return drop(c);
+            }
+        } while (c.out_sent == c.out.size() && whole_frame(c.in));
+        // a client that hung up still gets the replies to everything it
+        // sent; what is left in c.in now is at most a partial frame
+        if (c.peer_closed && c.out_sent == c.out.size())
+        {
+            return drop(c);
+        }
+        uint32_t want = 0;
+        if (!c.peer_closed && c.out.size() - c.out_sent < max_pending_out)
+        {
+            want |= EPOLLIN;
+        }
+        if (c.out_sent < c.out.size())
+        {
+            want |= EPOLLOUT;
+        }
+        watch(c, want);
+    }
+
+    static bool whole_frame(const std::string& in)
+    {
+        return in.size() >= server_frame_header && in.size() - sizeof(uint32_t) >= server_wire::get_u32(in.data());
+    }
+
+    // answers every whole frame in c.in while the replies fit; false if a
+    // frame is too large to be a request
+    bool handle_requests(Connection& c)
+    {
+        size_t pos = 0;
+        while (c.in.size() - pos >= server_frame_header && c.out.size() - c.out_sent < max_pending_out)
+        {
+            size_t size = server_wire::get_u32(c.in.data() + pos) + sizeof(uint32_t);
+            if (size < server_frame_header || size > server_max_frame)
+            {
+                return false;
+            }
+            if (c.in.size() - pos < size)
+            {
+                break;
+            }
+            std::string_view frame(c.in.data() + pos, size);
+            answer((ServerOp)frame[4], server_wire::get_u32(frame.data() + 5),
+                   frame.substr(server_frame_header), c.out);
+            requests++;
+            pos += size;
+        }
+        c.in.erase(0, pos);
+        return true;
+    }
+
+    // one send for everything pending; false if the peer is gone
+    bool send_replies(Connection& c)
+    {
+        while (c.out_sent < c.out.size())
+        {
+            ssize_t sent = ::send(c.fd, c.out.data() + c.out_sent, c.out.size() - c.out_sent, MSG_NOSIGNAL);
+            if (sent < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return errno == EAGAIN;
+            }
+            c.out_sent += (size_t)sent;
+        }
+        c.out.clear();
+        c.out_sent = 0;
+        return true;
+    }
+
+    void reply(std::string& out, ServerStatus status, uint32_t tag)
+    {
+        server_wire::end_frame(out, server_wire::begin_frame(out, (uint8_t)status, tag));
+    }
+
+    void answer(ServerOp op, uint32_t tag, std::string_view payload, std::string& out)
+    {
+        int roll_no = 0, marks[4];
+        std::string_view name;
+        bool with_record = op == ServerOp::Add || op == ServerOp::Update;
+        bool with_roll = op == ServerOp::Get || op == ServerOp::Delete;
+        if ((with_record && !server_wire::get_record(payload, roll_no, marks, name)) ||
+            (with_roll && payload.size() != 4) || (op == ServerOp::Top && payload.size() != 4) ||
+            (!with_record && !with_roll && op != ServerOp::Top))
+        {
+            return reply(out, ServerStatus::BadRequest, tag);
+        }
+        if (with_roll)
+        {
+            roll_no = (int)server_wire::get_u32(payload.data());
+        }
+
+        Student st;
+        switch (op)
+        {
+        case ServerOp::Add:
+            if (!registry.add(name, roll_no, marks))
+            {
+                // or the name did not fit in the registry's name pool
+                return reply(out, registry.contains(roll_no) ? ServerStatus::Exists : ServerStatus::BadRequest, tag);
+            }
+            break;
+        case ServerOp::Update:
+            st.set_data(std::string(name), roll_no, marks);
+            if (!registry.update(st))
+            {
+                return reply(out, registry.contains(roll_no) ? ServerStatus::BadRequest : ServerStatus::NotFound, tag);
+            }
+            break;
+        case ServerOp::Get:
+        case ServerOp::Delete:
+            if (!registry.get(roll_no, st) || (op == ServerOp::Delete && !registry.remove(roll_no)))
+            {
+                return reply(out, ServerStatus::NotFound, tag);
+            }
+            break;
+        case ServerOp::Top:
+            return reply_top(out, tag, std::min(server_wire::get_u32(payload.data()), server_max_top));
+        }
+
+        if (op == ServerOp::Get)
+        {
+            int found[4] = {st.get_marks(0), st.get_marks(1), st.get_marks(2), st.get_marks(3)};
+            size_t start = server_wire::begin_frame(out, (uint8_t)ServerStatus::Ok, tag);
+            server_wire::put_record(out, roll_no, found, st.get_name());
+            return server_wire::end_frame(out, start);
+        }
+        if (on_change)
+        {
+            if (op == ServerOp::Delete)
+            {
+                int removed[4] = {st.get_marks(0), st.get_marks(1), st.get_marks(2), st.get_marks(3)};
+                on_change(WalOp::Delete, roll_no, removed, st.get_name());
+            }
+            else
+            {
+                on_change(op == ServerOp::Add ? WalOp::Add : WalOp::Update, roll_no, marks, name);
+            }
+        }
+        reply(out, ServerStatus::Ok, tag);
+    }
+
+    void reply_top(std::string& out, uint32_t tag, uint32_t k)
+    {
+        size_t start = server_wire::begin_frame(out, (uint8_t)ServerStatus::Ok, tag);
+        size_t count_at = out.size();
+        server_wire::put_u32(out, 0);
+        uint32_t count = 0;
+        registry.top_by_total(k, [&](int roll_no, int total)
+        {
+            server_wire::put_u32(out, (uint32_t)roll_no);
+            server_wire::put_u32(out, (uint32_t)total);
+            count++;
+        });
+        std::memcpy(&out[count_at], &count, sizeof(count));
+        server_wire::end_frame(out, start);
+    }
+};
+
+#endif
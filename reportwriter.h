@@ -0,0 +1,266 @@
+// Buffered output path for "Display all student data".
+//
+// Each record is formatted straight into a reusable buffer (integers via
+// std::to_chars) and the buffer goes to the file descriptor in large
+// blocks, instead of one flushed cout line per field. Besides the menu's
+// text layout it can emit CSV (the same layout --batch reads back) or
+// JSON lines, and can stop after every page of rows for a pager prompt.
+// A writer on fd -1 only collects its text, so chunks of a listing can be
+// formatted in parallel and then written out in order.
+#ifndef REPORTWRITER_H
+#define REPORTWRITER_H
+
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include <unistd.h>
+
+enum class ReportFormat
+{
+    Text,
+    Csv,
+    Json
+};
+
+inline bool parse_report_format(std::string_view name, ReportFormat& out)
+{
+    if (name == "text")
+    {
+        out = ReportFormat::Text;
+    }
+    else if (name == "csv")
+    {
+        out = ReportFormat::Csv;
+    }
+    else if (name == "json")
+    {
+        out = ReportFormat::Json;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+class ReportWriter
+{
+public:
+    static const size_t block_size = 64 * 1024;
+
+    // on_page runs after every page_rows rows (0 = no paging) with the
+    // output flushed; returning false ends the report early
+    explicit ReportWriter(int fd = STDOUT_FILENO, ReportFormat format = ReportFormat::Text,
+                          size_t page_rows = 0, std::function<bool()> on_page = nullptr)
+        : fd(fd), format(format), page_rows(page_rows), on_page(std::move(on_page))
+    {
+        buffer.reserve(block_size + 512);
+    }
+
+    ~ReportWriter()
+    {
+        flush();
+    }
+
+    // false once the pager asked to stop or the output failed
+    bool row(int roll_no, const int* marks, std::string_view name)
+    {
+        if (stopped)
+        {
+            return false;
+        }
+        if (rows++ == 0 && format == ReportFormat::Csv)
+        {
+            text("name,roll_no,mark1,mark2,mark3,mark4\n");
+        }
+        switch (format)
+        {
+        case ReportFormat::Text:
+            text("Displaying data for student ");
+            number((long long)rows);
+            text(":\nName of student is: ");
+            text(name);
+            text("\nRoll no of student is: ");
+            number(roll_no);
+            text("\nStudent marks are: ");
+            for (int i = 0; i < 4; i++)
+            {
+                text("Marks ");
+                number(i + 1);
+                text(": ");
+                number(marks[i]);
+                text("\n");
+            }
+            break;
+        case ReportFormat::Csv:
+            csv_field(name);
+            text(",");
+            number(roll_no);
+            for (int i = 0; i < 4; i++)
+            {
+                text(",");
+                number(marks[i]);
+            }
+            text("\n");
+            break;
+        case ReportFormat::Json:
+            text("{\"name\":");
+            json_string(name);
+            text(",\"roll_no\":");
+            number(roll_no);
+            text(",\"marks\":[");
+            for (int i = 0; i < 4; i++)
+            {
+                if (i)
+                {
+                    text(",");
+                }
+                number(marks[i]);
+            }
+            text("]}\n");
+            break;
+        }
+        if (buffer.size() >= block_size)
+        {
+            flush();
+        }
+        if (page_rows && on_page && rows % page_rows == 0)
+        {
+            flush();
+            if (!on_page())
+            {
+                stopped = true;
+            }
+        }
+        return !stopped;
+    }
+
+    size_t rows_written() const
+    {
+        return rows;
+    }
+
+    // numbers the next row as if n rows came before it (and so leaves out
+    // the CSV header), for a chunk that starts mid-listing
+    void continue_after(size_t n)
+    {
+        rows += n;
+    }
+
+    // the text collected so far by a writer on fd -1
+    std::string take()
+    {
+        std::string text;
+        text.swap(buffer);
+        return text;
+    }
+
+    // writes text another writer formatted, after anything still buffered
+    bool write_formatted(std::string_view text)
+    {
+        return flush() && write_out(text.data(), text.size());
+    }
+
+    bool flush()
+    {
+        if (fd < 0)
+        {
+            return !stopped;
+        }
+        write_out(buffer.data(), buffer.size());
+        buffer.clear();
+        return !stopped;
+    }
+
+private:
+    int fd;
+    ReportFormat format;
+    size_t page_rows;
+    std::function<bool()> on_page;
+    std::string buffer;
+    size_t rows = 0;
+    bool stopped = false;
+
+    bool write_out(const char* p, size_t n)
+    {
+        while (n > 0 && !stopped)
+        {
+            ssize_t w = ::write(fd, p, n);
+            if (w < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                stopped = true;
+                break;
+            }
+            p += w;
+            n -= (size_t)w;
+        }
+        return !stopped;
+    }
+
+    void text(std::string_view s)
+    {
+        buffer.append(s.data(), s.size());
+    }
+
+    void number(long long v)
+    {
+        char digits[24];
+        std::to_chars_result r = std::to_chars(digits, digits + sizeof(digits), v);
+        buffer.append(digits, (size_t)(r.ptr - digits));
+    }
+
+    void csv_field(std::string_view s)
+    {
+        if (s.find_first_of(",\"\n\r") == std::string_view::npos)
+        {
+            text(s);
+            return;
+        }
+        buffer += '"';
+        for (char c : s)
+        {
+            if (c == '"')
+            {
+                buffer += '"';
+            }
+            buffer += c;
+        }
+        buffer += '"';
+    }
+
+    void json_string(std::string_view s)
+    {
+        buffer += '"';
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+            {
+                buffer += '\\';
+                buffer += c;
+            }
+            else if ((unsigned char)c < 0x20)
+            {
+                char esc[8];
+                std::snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char)c);
+                buffer += esc;
+            }
+            else
+            {
+                buffer += c;
+            }
+        }
+        buffer += '"';
+    }
+};
+
+#endif
@@ -0,0 +1,193 @@
+// Open-addressing hash index from roll number to record slot.
+// Linear probing over a power-of-two table; erase uses backward-shift
+// deletion so the table never accumulates tombstones.
+#ifndef ROLLINDEX_H
+#define ROLLINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class RollIndex
+{
+public:
+    static const uint32_t npos = UINT32_MAX;
+
+    RollIndex()
+    {
+        rehash(16);
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    void clear()
+    {
+        for (Entry& e : table)
+        {
+            e.slot = npos;
+        }
+        count = 0;
+    }
+
+    // make room for n keys without growing again
+    void reserve(size_t n)
+    {
+        size_t want = 16;
+        while (want * max_load_num < n * max_load_den)
+        {
+            want *= 2;
+        }
+        if (want > table.size())
+        {
+            rehash(want);
+        }
+    }
+
+    // drop to the smallest table that holds the current keys
+    void shrink_to_fit()
+    {
+        size_t want = 16;
+        while (want * max_load_num < count * max_load_den)
+        {
+            want *= 2;
+        }
+        if (want < table.size())
+        {
+            rehash(want);
+        }
+    }
+
+    uint32_t find(int roll_no) const
+    {
+        size_t i = home(roll_no);
+        while (table[i].slot != npos)
+        {
+            if (table[i].key == roll_no)
+            {
+                return table[i].slot;
+            }
+            i = (i + 1) & mask;
+        }
+        return npos;
+    }
+
+    // returns false if roll_no is already present
+    bool insert(int roll_no, uint32_t slot)
+    {
+        if ((count + 1) * max_load_den > table.size() * max_load_num)
+        {
+            rehash(table.size() * 2);
+        }
+        size_t i = home(roll_no);
+        while (table[i].slot != npos)
+        {
+            if (table[i].key == roll_no)
+            {
+                return false;
+            }
+            i = (i + 1) & mask;
+        }
+        table[i].key = roll_no;
+        table[i].slot = slot;
+        count++;
+        return true;
+    }
+
+    // repoint an existing key at a new slot (records moved in storage)
+    void assign(int roll_no, uint32_t slot)
+    {
+        size_t i = home(roll_no);
+        while (table[i].slot != npos)
+        {
+            if (table[i].key == roll_no)
+            {
+                table[i].slot = slot;
+                return;
+            }
+            i = (i + 1) & mask;
+        }
+    }
+
+    bool erase(int roll_no)
+    {
+        size_t i = home(roll_no);
+        while (table[i].slot != npos && table[i].key != roll_no)
+        {
+            i = (i + 1) & mask;
+        }
+        if (table[i].slot == npos)
+        {
+            return false;
+        }
+
+        // pull later members of the probe run back over the hole
+        size_t hole = i;
+        size_t j = i;
+        while (true)
+        {
+            j = (j + 1) & mask;
+            if (table[j].slot == npos)
+            {
+                break;
+            }
+            size_t h = home(table[j].key);
+            bool movable = (hole <= j) ? (h <= hole || h > j) : (h <= hole && h > j);
+            if (movable)
+            {
+                table[hole] = table[j];
+                hole = j;
+            }
+        }
+        table[hole].slot = npos;
+        count--;
+        return true;
+    }
+
+private:
+    struct Entry
+    {
+        int key;
+        uint32_t slot;
+    };
+
+    // keep the load factor at or below 1/2
+    static const size_t max_load_num = 1;
+    static const size_t max_load_den = 2;
+
+    std::vector<Entry> table;
+    size_t mask = 0;
+    size_t count = 0;
+
+    size_t home(int roll_no) const
+    {
+        uint64_t h = (uint64_t)(uint32_t)roll_no * 0x9E3779B97F4A7C15ull;
+        return (size_t)(h >> 32) & mask;
+    }
+
+    void rehash(size_t new_size)
+    {
+        std::vector<Entry> old;
+        old.swap(table);
+        table.assign(new_size, Entry{0, npos});
+        mask = new_size - 1;
+        count = 0;
+        for (const Entry& e : old)
+        {
+            if (e.slot != npos)
+            {
+                size_t i = home(e.key);
+                while (table[i].slot != npos)
+                {
+                    i = (i + 1) & mask;
+                }
+                table[i] = e;
+                count++;
+            }
+        }
+    }
+};
+
+#endif
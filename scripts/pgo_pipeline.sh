@@ -0,0 +1,105 @@
+#!/usr/bin/env bash
+# Builds the demo driver with profile-guided and link-time optimization,
+# trained on a scripted studentrecord workload, and reports how much faster
+# each variant runs that workload than a plain -O2 build.
+#
+# bench/workload_gen.cpp writes two workloads that drive add, show (find),
+# update, delete, search, top and list (display) through --script: one,
+# with seed 1, is the training run for the instrumented build; the other,
+# with seed 2, is what every variant is timed on. Every variant compiles at
+# -O2, so the differences come from LTO, the profile and -march alone. A
+# PGO variant is trained and rebuilt in a build directory of its own, since
+# its profile has to come from code built for the same -march. Each
+# variant's output must match the -O2 build's. Times are measured by
+# demo --time; the speedup compares medians.
+#   usage: scripts/pgo_pipeline.sh [students] [operations] [runs]
+#          (default 100000 300000 5)
+#   MARCH_VARIANTS="x86-64-v3 native" picks the -march builds (empty for
+#   none); BUILD_ROOT (default build/pgo-pipeline) is where everything goes
+set -euo pipefail
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+students=${1:-100000}
+operations=${2:-300000}
+runs=${3:-5}
+out=${BUILD_ROOT:-$root/build/pgo-pipeline}
+march_variants=${MARCH_VARIANTS-x86-64-v3 native}
+jobs=$(nproc 2>/dev/null || echo 1)
+mkdir -p "$out"
+
+# build NAME [cmake args...]: the demo driver at -O2 in $out/NAME
+build() {
+    local dir=$out/$1
+    shift
+    if ! { cmake -S "$root" -B "$dir" -DCMAKE_BUILD_TYPE=Release -DCMAKE_CXX_FLAGS_RELEASE="-O2 -DNDEBUG" \
+               -DDEMOS_BENCHMARKS=OFF "$@" &&
+           cmake --build "$dir" -j"$jobs" --target demo; } >"$dir.log" 2>&1; then
+        cat "$dir.log" >&2
+        echo "build of $dir failed" >&2
+        exit 1
+    fi
+}
+
+# run BINARY SCRIPT OUTPUT: one run on a fresh registry; prints its milliseconds
+run() {
+    local work=$out/work
+    rm -rf "$work"
+    mkdir -p "$work"
+    "$1" --time students --snapshot "$work/students.snap" --script "$2" >"$3" 2>"$work/stderr" || return 1
+    sed -n 's/^students: \([0-9.]*\) ms.*/\1/p' "$work/stderr"
+}
+
+# measure NAME LABEL: times the variant built in $out/NAME on the workload
+results=()
+measure() {
+    local times=() t
+    for ((r = 0; r < runs; r++)); do
+        t=$(run "$out/$1/demo" "$out/eval.txt" "$out/$1.out")
+        times+=("$t")
+    done
+    if [[ $1 != o2 ]] && ! cmp -s "$out/o2.out" "$out/$1.out"; then
+        echo "$2: output differs from the -O2 build" >&2
+        exit 1
+    fi
+    local sorted median
+    sorted=$(printf '%s\n' "${times[@]}" | sort -n)
+    median=$(sed -n "$(((runs + 1) / 2))p" <<<"$sorted")
+    results+=("$2|$median|$(head -n 1 <<<"$sorted")")
+    echo "$2: ${times[*]} ms" >&2
+}
+
+# pgo NAME LABEL [cmake args...]: train, rebuild with the profile, measure
+pgo() {
+    local name=$1 label=$2
+    shift 2
+    rm -rf "$out/$name/pgo-profiles"
+    build "$name" -DDEMOS_LTO=ON -DDEMOS_PGO=generate "$@"
+    if ! run "$out/$name/demo" "$out/train.txt" /dev/null >/dev/null; then
+        echo "$label: training run failed (does this CPU support it?), skipped" >&2
+        return
+    fi
+    build "$name" -DDEMOS_LTO=ON -DDEMOS_PGO=use "$@"
+    measure "$name" "$label"
+}
+
+"${CXX:-c++}" -std=c++17 -O2 "$root/bench/workload_gen.cpp" -o "$out/workload_gen"
+"$out/workload_gen" "$students" "$operations" 1 >"$out/train.txt"
+"$out/workload_gen" "$students" "$operations" 2 >"$out/eval.txt"
+echo "workload: $students students, $operations operations, $runs timed runs per variant" >&2
+
+build o2
+measure o2 "-O2"
+build lto -DDEMOS_LTO=ON
+measure lto "-O2 + LTO"
+pgo pgo "-O2 + LTO + PGO"
+for march in $march_variants; do
+    pgo "pgo-$march" "-O2 + LTO + PGO, -march=$march" -DDEMOS_MARCH="$march"
+done
+
+IFS='|' read -r _ base _ <<<"${results[0]}"
+printf '\n%-36s %10s %10s %9s\n' "variant" "median ms" "min ms" "speedup"
+for entry in "${results[@]}"; do
+    IFS='|' read -r label median fastest <<<"$entry"
+    printf '%-36s %10.1f %10.1f %8.2fx\n' "$label" "$median" "$fastest" \
+        "$(awk -v b="$base" -v m="$median" 'BEGIN { print b / m }')"
+done
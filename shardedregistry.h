@@ -0,0 +1,386 @@
+// Student registry that many threads can use at once.
+//
+// Records are split across shards by a hash of the roll number. Each shard
+// is an open-addressing table of pointers to immutable records:
+//   - readers take no lock: they enter an epoch (see epoch.h), load the
+//     table and record pointers with acquire loads and copy the record out;
+//   - writers take the shard's mutex, publish a new record (or a new, larger
+//     table) with a release store, and retire what they replaced. Retired
+//     memory is freed once no reader that could still see it is active.
+// Deleted entries become tombstones so a concurrent probe never misses a
+// record further along its chain; tombstones are dropped when a table is
+// rebuilt.
+#ifndef SHARDEDREGISTRY_H
+#define SHARDEDREGISTRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "epoch.h"
+#include "student.h"
+
+class ShardedRegistry
+{
+public:
+    explicit ShardedRegistry(size_t shard_count = 64)
+    {
+        while ((size_t(1) << shard_bits) < shard_count)
+        {
+            shard_bits++;
+        }
+        shards.reset(new Shard[size_t(1) << shard_bits]);
+        for (size_t i = 0; i < (size_t(1) << shard_bits); i++)
+        {
+            shards[i].table.store(new_table(16), std::memory_order_relaxed);
+        }
+    }
+
+    ShardedRegistry(const ShardedRegistry&) = delete;
+    ShardedRegistry& operator=(const ShardedRegistry&) = delete;
+
+    // no reader or writer may still be running
+    ~ShardedRegistry()
+    {
+        for (size_t i = 0; i < shard_count(); i++)
+        {
+            Shard& sh = shards[i];
+            Table* t = sh.table.load(std::memory_order_relaxed);
+            for (size_t k = 0; k <= t->mask; k++)
+            {
+                const Record* r = t->slots[k].load(std::memory_order_relaxed);
+                if (r && r != tombstone())
+                {
+                    delete r;
+                }
+            }
+            delete t;
+            for (const Retired& old : sh.limbo)
+            {
+                free_retired(old);
+            }
+        }
+    }
+
+    size_t shard_count() const
+    {
+        return size_t(1) << shard_bits;
+    }
+
+    size_t size() const
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < shard_count(); i++)
+        {
+            n += shards[i].live.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    // lock-free
+    bool get(int roll_no, Student& out) const
+    {
+        EpochGuard guard;
+        const Record* r = find(roll_no);
+        if (!r)
+        {
+            return false;
+        }
+        out.set_data(r->name, r->roll_no, r->marks);
+        return true;
+    }
+
+    // lock-free
+    bool contains(int roll_no) const
+    {
+        EpochGuard guard;
+        return find(roll_no) != nullptr;
+    }
+
+    bool add(const Student& st)
+    {
+        int marks[4] = {st.get_marks(0), st.get_marks(1), st.get_marks(2), st.get_marks(3)};
+        return add(st.get_name(), st.get_roll_no(), marks);
+    }
+
+    bool add(std::string_view name, int roll_no, const int* marks)
+    {
+        uint64_t h = hash(roll_no);
+        Shard& sh = shard_for(h);
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        Table* t = sh.table.load(std::memory_order_relaxed);
+        size_t free_slot = SIZE_MAX;
+        size_t i = h & t->mask;
+        while (const Record* r = t->slots[i].load(std::memory_order_relaxed))
+        {
+            if (r == tombstone())
+            {
+                free_slot = free_slot == SIZE_MAX ? i : free_slot;
+            }
+            else if (r->roll_no == roll_no)
+            {
+                return false;
+            }
+            i = (i + 1) & t->mask;
+        }
+        if (free_slot == SIZE_MAX)
+        {
+            if ((sh.used + 1) * 2 > t->mask + 1)
+            {
+                t = grow(sh);
+                free_slot = h & t->mask;
+                while (t->slots[free_slot].load(std::memory_order_relaxed))
+                {
+                    free_slot = (free_slot + 1) & t->mask;
+                }
+            }
+            else
+            {
+                free_slot = i;
+            }
+            sh.used++;
+        }
+        t->slots[free_slot].store(make_record(name, roll_no, marks), std::memory_order_release);
+        sh.live.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // replaces the record with st's roll number; false if there is none
+    bool update(const Student& st)
+    {
+        int marks[4] = {st.get_marks(0), st.get_marks(1), st.get_marks(2), st.get_marks(3)};
+        uint64_t h = hash(st.get_roll_no());
+        Shard& sh = shard_for(h);
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        std::atomic<const Record*>* slot = locate(sh, h, st.get_roll_no());
+        if (!slot)
+        {
+            return false;
+        }
+        const Record* old = slot->load(std::memory_order_relaxed);
+        slot->store(make_record(st.get_name(), st.get_roll_no(), marks), std::memory_order_release);
+        retire(sh, old, false);
+        return true;
+    }
+
+    bool remove(int roll_no)
+    {
+        uint64_t h = hash(roll_no);
+        Shard& sh = shard_for(h);
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        std::atomic<const Record*>* slot = locate(sh, h, roll_no);
+        if (!slot)
+        {
+            return false;
+        }
+        const Record* old = slot->load(std::memory_order_relaxed);
+        slot->store(tombstone(), std::memory_order_release);
+        sh.live.fetch_sub(1, std::memory_order_relaxed);
+        retire(sh, old, false);
+        return true;
+    }
+
+    // f(const Student&) for every record; each shard is read lock-free, so
+    // concurrent writes may or may not be seen
+    template <class F>
+    void for_each(F f) const
+    {
+        Student st;
+        for (size_t s = 0; s < shard_count(); s++)
+        {
+            EpochGuard guard;
+            const Table* t = shards[s].table.load(std::memory_order_acquire);
+            for (size_t k = 0; k <= t->mask; k++)
+            {
+                const Record* r = t->slots[k].load(std::memory_order_acquire);
+                if (r && r != tombstone())
+                {
+                    st.set_data(r->name, r->roll_no, r->marks);
+                    f(st);
+                }
+            }
+        }
+    }
+
+private:
+    struct Record
+    {
+        int roll_no;
+        int marks[4];
+        std::string name;
+    };
+
+    struct Table
+    {
+        size_t mask;
+        std::unique_ptr<std::atomic<const Record*>[]> slots;
+    };
+
+    struct Retired
+    {
+        uint64_t epoch;
+        const void* p;
+        bool is_table;
+    };
+
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+        std::atomic<Table*> table{nullptr};
+        std::atomic<size_t> live{0};
+        size_t used = 0;  // live + tombstones, writer-only
+        std::vector<Retired> limbo;
+    };
+
+    static const size_t reclaim_batch = 64;
+
+    unsigned shard_bits = 0;
+    std::unique_ptr<Shard[]> shards;
+
+    static const Record* tombstone()
+    {
+        static const Record dead{0, {0, 0, 0, 0}, std::string()};
+        return &dead;
+    }
+
+    static uint64_t hash(int roll_no)
+    {
+        uint64_t h = (uint64_t)(uint32_t)roll_no * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 29);
+    }
+
+    Shard& shard_for(uint64_t h) const
+    {
+        return shards[shard_bits ? h >> (64 - shard_bits) : 0];
+    }
+
+    static Table* new_table(size_t capacity)
+    {
+        Table* t = new Table;
+        t->mask = capacity - 1;
+        t->slots.reset(new std::atomic<const Record*>[capacity]);
+        for (size_t i = 0; i < capacity; i++)
+        {
+            t->slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+        return t;
+    }
+
+    static const Record* make_record(std::string_view name, int roll_no, const int* marks)
+    {
+        Record* r = new Record;
+        r->roll_no = roll_no;
+        for (int k = 0; k < 4; k++)
+        {
+            r->marks[k] = marks[k];
+        }
+        r->name.assign(name.data(), name.size());
+        return r;
+    }
+
+    // caller is inside an epoch
+    const Record* find(int roll_no) const
+    {
+        uint64_t h = hash(roll_no);
+        const Table* t = shard_for(h).table.load(std::memory_order_acquire);
+        size_t i = h & t->mask;
+        while (const Record* r = t->slots[i].load(std::memory_order_acquire))
+        {
+            if (r != tombstone() && r->roll_no == roll_no)
+            {
+                return r;
+            }
+            i = (i + 1) & t->mask;
+        }
+        return nullptr;
+    }
+
+    // writer-side lookup; caller holds the shard mutex
+    std::atomic<const Record*>* locate(Shard& sh, uint64_t h, int roll_no)
+    {
+        Table* t = sh.table.load(std::memory_order_relaxed);
+        size_t i = h & t->mask;
+        while (const Record* r = t->slots[i].load(std::memory_order_relaxed))
+        {
+            if (r != tombstone() && r->roll_no == roll_no)
+            {
+                return &t->slots[i];
+            }
+            i = (i + 1) & t->mask;
+        }
+        return nullptr;
+    }
+
+    // rebuilds the shard's table at 4x its live count, without tombstones,
+    // and publishes it; caller holds the shard mutex
+    Table* grow(Shard& sh)
+    {
+        Table* old = sh.table.load(std::memory_order_relaxed);
+        size_t live = sh.live.load(std::memory_order_relaxed);
+        size_t capacity = 16;
+        while (capacity < (live + 1) * 4)
+        {
+            capacity *= 2;
+        }
+        Table* t = new_table(capacity);
+        for (size_t k = 0; k <= old->mask; k++)
+        {
+            const Record* r = old->slots[k].load(std::memory_order_relaxed);
+            if (r && r != tombstone())
+            {
+                size_t i = hash(r->roll_no) & t->mask;
+                while (t->slots[i].load(std::memory_order_relaxed))
+                {
+                    i = (i + 1) & t->mask;
+                }
+                t->slots[i].store(r, std::memory_order_relaxed);
+            }
+        }
+        sh.used = live;
+        sh.table.store(t, std::memory_order_release);
+        retire(sh, old, true);
+        return t;
+    }
+
+    void retire(Shard& sh, const void* p, bool is_table)
+    {
+        sh.limbo.push_back(Retired{EpochDomain::instance().retire_epoch(), p, is_table});
+        if (sh.limbo.size() < reclaim_batch)
+        {
+            return;
+        }
+        uint64_t oldest = EpochDomain::instance().oldest_active();
+        size_t kept = 0;
+        for (const Retired& old : sh.limbo)
+        {
+            if (old.epoch < oldest)
+            {
+                free_retired(old);
+            }
+            else
+            {
+                sh.limbo[kept++] = old;
+            }
+        }
+        sh.limbo.resize(kept);
+    }
+
+    static void free_retired(const Retired& old)
+    {
+        if (old.is_table)
+        {
+            delete (const Table*)old.p;
+        }
+        else
+        {
+            delete (const Record*)old.p;
+        }
+    }
+};
+
+#endif
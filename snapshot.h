@@ -0,0 +1,352 @@
+// On-disk snapshot of the student registry.
+//
+// Layout (little-endian, version 1):
+//   SnapshotHeader      64 bytes
+//   SnapshotRecord[n]   fixed-width, 32 bytes each
+//   name heap           the names back to back, referenced by offset/length
+//
+// SnapshotView maps a file read-only and validates only the header, so
+// opening is O(1) whatever the size; records are decoded when asked for.
+// SnapshotWriter writes to "<path>.tmp", fsyncs and renames over <path>,
+// so a crash leaves either the old snapshot or the new one, never a mix.
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "student.h"
+
+static const char snapshot_magic[8] = {'S', 'T', 'U', 'D', 'S', 'N', 'A', 'P'};
+static const uint32_t snapshot_version = 1;
+
+struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t count;
+    uint64_t records_offset;
+    uint64_t names_offset;
+    uint64_t names_size;
+    uint64_t reserved[2];
+};
+
+struct SnapshotRecord
+{
+    int32_t roll_no;
+    int32_t marks[4];
+    uint32_t name_length;
+    uint64_t name_offset;
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "snapshot header must stay 64 bytes");
+static_assert(sizeof(SnapshotRecord) == 32, "snapshot records must stay 32 bytes");
+
+class SnapshotView
+{
+public:
+    SnapshotView() = default;
+    SnapshotView(const SnapshotView&) = delete;
+    SnapshotView& operator=(const SnapshotView&) = delete;
+
+    ~SnapshotView()
+    {
+        close();
+    }
+
+    bool open(const std::string& path, std::string& error)
+    {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            error = "cannot open " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader))
+        {
+            ::close(fd);
+            error = path + " is too small to be a snapshot";
+            return false;
+        }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+        {
+            error = "cannot map " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        base = (const char*)p;
+        length = (size_t)st.st_size;
+
+        const SnapshotHeader* h = header();
+        if (std::memcmp(h->magic, snapshot_magic, sizeof(snapshot_magic)) != 0)
+        {
+            error = path + " is not a student snapshot";
+        }
+        else if (h->version != snapshot_version || h->record_size != sizeof(SnapshotRecord))
+        {
+            error = path + " has unsupported snapshot version " + std::to_string(h->version);
+        }
+        // each bound is checked against what is left of the file before
+        // anything is added or multiplied, so no header value can wrap
+        else if (h->records_offset > length ||
+                 h->count > (length - h->records_offset) / sizeof(SnapshotRecord) ||
+                 h->names_offset > length || h->names_size > length - h->names_offset)
+        {
+            error = path + " is truncated";
+        }
+        else if (h->records_offset % alignof(SnapshotRecord) != 0)
+        {
+            error = path + " has misaligned records";
+        }
+        else
+        {
+            return true;
+        }
+        close();
+        return false;
+    }
+
+    void close()
+    {
+        if (base)
+        {
+            munmap((void*)base, length);
+            base = nullptr;
+            length = 0;
+        }
+    }
+
+    bool is_open() const
+    {
+        return base != nullptr;
+    }
+
+    size_t size() const
+    {
+        return base ? (size_t)header()->count : 0;
+    }
+
+    // bytes in the name heap
+    size_t names_size() const
+    {
+        return base ? (size_t)header()->names_size : 0;
+    }
+
+    const SnapshotRecord& record(size_t i) const
+    {
+        return records()[i];
+    }
+
+    // empty if the record's name range lies outside the name heap
+    std::string_view name(size_t i) const
+    {
+        const SnapshotRecord& r = records()[i];
+        const SnapshotHeader* h = header();
+        if (r.name_offset > h->names_size || r.name_length > h->names_size - r.name_offset)
+        {
+            return std::string_view();
+        }
+        return std::string_view(base + h->names_offset + r.name_offset, r.name_length);
+    }
+
+    // decodes record i into a Student
+    void get(size_t i, Student& out) const
+    {
+        const SnapshotRecord& r = records()[i];
+        out.set_data(std::string(name(i)), r.roll_no, r.marks);
+    }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+
+    const SnapshotHeader* header() const
+    {
+        return (const SnapshotHeader*)base;
+    }
+
+    const SnapshotRecord* records() const
+    {
+        return (const SnapshotRecord*)(base + header()->records_offset);
+    }
+};
+
+class SnapshotWriter
+{
+public:
+    SnapshotWriter() = default;
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    ~SnapshotWriter()
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+            unlink(tmp_path.c_str());
+        }
+    }
+
+    // starts a snapshot of exactly count records
+    bool open(const std::string& path, size_t count, std::string& error)
+    {
+        final_path = path;
+        tmp_path = path + ".tmp";
+        expected = count;
+        fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            error = "cannot create " + tmp_path + ": " + std::strerror(errno);
+            return false;
+        }
+        SnapshotHeader h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, snapshot_magic, sizeof(snapshot_magic));
+        h.version = snapshot_version;
+        h.record_size = sizeof(SnapshotRecord);
+        h.count = count;
+        h.records_offset = sizeof(SnapshotHeader);
+        h.names_offset = h.records_offset + count * sizeof(SnapshotRecord);
+        buffer.reserve(buffer_size);
+        append(&h, sizeof(h));
+        return true;
+    }
+
+    void add(int roll_no, const int* marks, std::string_view name)
+    {
+        SnapshotRecord r;
+        r.roll_no = roll_no;
+        for (int k = 0; k < 4; k++)
+        {
+            r.marks[k] = marks[k];
+        }
+        r.name_length = (uint32_t)name.size();
+        r.name_offset = names.size();
+        names.append(name.data(), name.size());
+        append(&r, sizeof(r));
+        written++;
+    }
+
+    void add(const Student& st)
+    {
+        int marks[4] = {st.get_marks(0), st.get_marks(1), st.get_marks(2), st.get_marks(3)};
+        add(st.get_roll_no(), marks, st.get_name());
+    }
+
+    // writes the name heap, makes the file durable and renames it into place
+    bool commit(std::string& error)
+    {
+        if (written != expected)
+        {
+            error = "snapshot expected " + std::to_string(expected) + " records, got " +
+                    std::to_string(written);
+            return false;
+        }
+        append(names.data(), names.size());
+        if (!flush())
+        {
+            error = "write to " + tmp_path + " failed: " + std::strerror(errno);
+            return false;
+        }
+        // the header was written before the heap size was known
+        uint64_t names_size = names.size();
+        if (pwrite(fd, &names_size, sizeof(names_size), offsetof(SnapshotHeader, names_size)) !=
+                (ssize_t)sizeof(names_size) ||
+            fsync(fd) != 0)
+        {
+            error = "write to " + tmp_path + " failed: " + std::strerror(errno);
+            return false;
+        }
+        ::close(fd);
+        fd = -1;
+        if (rename(tmp_path.c_str(), final_path.c_str()) != 0)
+        {
+            error = "cannot rename " + tmp_path + ": " + std::strerror(errno);
+            unlink(tmp_path.c_str());
+            return false;
+        }
+        sync_directory();
+        return true;
+    }
+
+private:
+    static const size_t buffer_size = 1 << 20;
+
+    int fd = -1;
+    std::string final_path;
+    std::string tmp_path;
+    std::string buffer;
+    std::string names;
+    size_t expected = 0;
+    size_t written = 0;
+    bool failed = false;
+
+    void append(const void* data, size_t n)
+    {
+        if (buffer.size() + n > buffer_size)
+        {
+            flush();
+        }
+        if (n > buffer_size)
+        {
+            write_all((const char*)data, n);
+            return;
+        }
+        buffer.append((const char*)data, n);
+    }
+
+    bool flush()
+    {
+        write_all(buffer.data(), buffer.size());
+        buffer.clear();
+        return !failed;
+    }
+
+    void write_all(const char* p, size_t n)
+    {
+        while (n > 0 && !failed)
+        {
+            ssize_t w = ::write(fd, p, n);
+            if (w < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                failed = true;
+                return;
+            }
+            p += w;
+            n -= (size_t)w;
+        }
+    }
+
+    // makes the rename itself durable
+    void sync_directory()
+    {
+        size_t slash = final_path.rfind('/');
+        std::string dir = slash == std::string::npos ? "." : final_path.substr(0, slash + 1);
+        int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dfd >= 0)
+        {
+            fsync(dfd);
+            ::close(dfd);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,117 @@
+// Student record used by studentrecord.cpp and the registry benchmarks.
+#ifndef STUDENT_H
+#define STUDENT_H
+
+#include <iostream>
+#include <string>
+
+#include "marksstats.h"
+
+class Student
+{
+    private:
+    std::string name;
+    int roll_no = 0, marks[4] = {0, 0, 0, 0};
+
+public:
+    Student() = default;
+
+    Student(const std::string& name, int roll_no, const int* marks)
+    {
+        set_data(name, roll_no, marks);
+    }
+
+    void set_data()
+    {
+        std::cout << "Enter the student name: ";
+        std::cin.ignore();
+        std::getline(std::cin, name);
+        std::cout << "Enter the student roll no: ";
+        std::cin >> roll_no;
+        std::cout << "Enter the student marks: ";
+        for (int i = 0; i < 4; i++)
+        {
+            std::cout << "Enter marks " << i + 1 << ": ";
+            std::cin >> marks[i];
+        }
+    }
+
+    // non-interactive form used for bulk loads
+    void set_data(const std::string& new_name, int new_roll_no, const int* new_marks)
+    {
+        name = new_name;
+        roll_no = new_roll_no;
+        for (int i = 0; i < 4; i++)
+        {
+            marks[i] = new_marks[i];
+        }
+    }
+
+    void display_data() const
+    {
+        std::cout << "Name of student is: " << name << std::endl;
+        std::cout << "Roll no of student is: " << roll_no << std::endl;
+        std::cout << "Student marks are: ";
+        for (int i = 0; i < 4; i++)
+        {
+            std::cout << "Marks " << i + 1 << ": " << marks[i] << std::endl;
+        }
+    }
+
+    void display_data(int roll_no) const
+    {
+        std::cout << "Name of student is: " << name << std::endl;
+        std::cout << "Roll no of student is: " << roll_no << std::endl;
+        std::cout << "Student marks are: ";
+        for (int i = 0; i < 4; i++)
+        {
+            std::cout << "Marks " << i + 1 << ": " << marks[i] << std::endl;
+        }
+    }
+
+    std::string get_name() const
+    {
+        return name;
+    }
+
+    int get_roll_no() const
+    {
+        return roll_no;
+    }
+
+    int get_marks(int i) const
+    {
+        return marks[i];
+    }
+
+    // total, percentage, mean and spread of the four marks
+    MarkSummary summary() const
+    {
+        return summarize_marks(marks, 4);
+    }
+
+    void update_data()
+    {
+        std::cout << "Enter new name: ";
+        std::cin.ignore();
+        std::getline(std::cin, name);
+        std::cout << "Enter new marks: ";
+        for (int i = 0; i < 4; i++)
+        {
+            std::cout << "Enter marks " << i + 1 << ": ";
+            std::cin >> marks[i];
+        }
+    }
+
+    void delete_data()
+    {
+        name = "";
+        roll_no = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            marks[i] = 0;
+        }
+    }
+};
+
+#endif
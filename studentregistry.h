@@ -0,0 +1,880 @@
+// Owns the student records and keeps a roll number -> slot hash index,
+// so find, update and delete are O(1) expected instead of a linear scan.
+//
+// Records are stored column-wise: roll numbers, each of the four mark
+// columns and names live in separate contiguous arrays, so analytics that
+// only read marks never touch the name strings. Names themselves sit back
+// to back in a NamePool arena rather than one heap string per record;
+// the bytes of renamed and deleted names are reclaimed in bulk when the
+// registry compacts. Student remains the value type going in and out of
+// the registry.
+//
+// Two secondary indexes are kept up to date on every mutation: an ordered
+// NameIndex for prefix and range search, and a RankTree over each
+// student's total for rank, top-k and median queries. Bulk loads switch
+// their maintenance off with defer_indexes(); the next query that needs
+// them rebuilds both in one sorted pass.
+//
+// Class statistics are computed in one pass on first request and cached
+// until the next add, update or delete. Per-student summaries (total,
+// percentage, mean, variance) are a lazily filled column: the first
+// summary() call allocates it, each row is computed on first read, and
+// update or remove invalidates that row only. Aggregates registered with
+// define_aggregate() are instead kept current on every change (see
+// aggregates.h), for figures that are read often.
+//
+// Bulk jobs over the whole roster (range checks, totals, grade bands and
+// formatted listings) split the rows into chunks on a TaskPool (see
+// taskpool.h); a listing's chunks are formatted into their own buffers
+// and written out in order.
+//
+// A registry can be attached to a mapped snapshot file in O(1); the
+// snapshot's records are decoded into the columns on first access.
+//
+// add, get, update, remove, find_by_prefix and top_by_total each time
+// themselves into the process-wide LatencyRecorder under a RegistryOp
+// (see latency.h); -DLATENCY_DISABLED compiles the timing out.
+//
+// Delete has two modes. SwapRemove moves the last record into the hole,
+// which is cheapest but changes display order. Stable leaves a tombstone
+// and compacts lazily once tombstones outnumber live records, so display
+// order is preserved and each delete is still O(1) amortized.
+#ifndef STUDENTREGISTRY_H
+#define STUDENTREGISTRY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "aggregates.h"
+#include "gradebands.h"
+#include "latency.h"
+#include "markkernels.h"
+#include "marksstats.h"
+#include "namepool.h"
+#include "nameindex.h"
+#include "ranktree.h"
+#include "reportwriter.h"
+#include "rollindex.h"
+#include "snapshot.h"
+#include "student.h"
+#include "taskpool.h"
+
+enum class DeleteMode
+{
+    SwapRemove,
+    Stable
+};
+
+// operations timed through latency.h; Display is timed by the caller
+enum class RegistryOp
+{
+    Add,
+    Find,
+    Update,
+    Delete,
+    Search,
+    Top,
+    Display
+};
+
+constexpr size_t registry_op_count = 7;
+
+inline const char* registry_op_name(RegistryOp op)
+{
+    static const char* const names[registry_op_count] = {"add", "find", "update", "delete",
+                                                         "search", "top", "display"};
+    return names[(size_t)op];
+}
+
+class StudentRegistry
+{
+public:
+    // rows per chunk of a bulk job
+    static const size_t bulk_grain = 16384;
+
+    explicit StudentRegistry(DeleteMode mode = DeleteMode::Stable) : mode(mode) {}
+
+    size_t size() const
+    {
+        if (pending)
+        {
+            return pending->size();
+        }
+        return rolls.size() - dead;
+    }
+
+    DeleteMode delete_mode() const
+    {
+        return mode;
+    }
+
+    void set_delete_mode(DeleteMode new_mode)
+    {
+        load_pending();
+        if (new_mode == DeleteMode::SwapRemove)
+        {
+            compact();
+        }
+        mode = new_mode;
+    }
+
+    size_t capacity() const
+    {
+        return rolls.capacity();
+    }
+
+    // sizes every column and the index for n students so a bulk load of
+    // that many never reallocates; storage otherwise grows geometrically
+    void reserve(size_t n)
+    {
+        rolls.reserve(n);
+        for (std::vector<int>& col : marks)
+        {
+            col.reserve(n);
+        }
+        names.reserve(n);
+        live.reserve(n);
+        index.reserve(n);
+    }
+
+    // returns memory left over after large deletes
+    void shrink_to_fit()
+    {
+        load_pending();
+        compact();
+        rolls.shrink_to_fit();
+        for (std::vector<int>& col : marks)
+        {
+            col.shrink_to_fit();
+        }
+        names.shrink_to_fit();
+        compact_names();
+        name_pool.shrink_to_fit();
+        live.shrink_to_fit();
+        summaries.shrink_to_fit();
+        summary_valid.shrink_to_fit();
+        index.shrink_to_fit();
+    }
+
+    // returns false if a student with the same roll number exists, or if
+    // the name does not fit: all names together are limited to
+    // NamePool::max_bytes (4 GB), dead bytes reclaimed first
+    bool add(const Student& st)
+    {
+        int row_marks[4] = {st.get_marks(0), st.get_marks(1), st.get_marks(2), st.get_marks(3)};
+        return add(st.get_name(), st.get_roll_no(), row_marks);
+    }
+
+    // field-wise form used by the bulk loaders, no Student round trip
+    bool add(std::string_view name, int roll_no, const int* row_marks)
+    {
+        LatencyScope timed((size_t)RegistryOp::Add);
+        load_pending();
+        return insert_row(name, roll_no, row_marks);
+    }
+
+    bool contains(int roll_no) const
+    {
+        load_pending();
+        return index.find(roll_no) != RollIndex::npos;
+    }
+
+    bool get(int roll_no, Student& out) const
+    {
+        LatencyScope timed((size_t)RegistryOp::Find);
+        load_pending();
+        uint32_t slot = index.find(roll_no);
+        if (slot == RollIndex::npos)
+        {
+            return false;
+        }
+        load_row(slot, out);
+        return true;
+    }
+
+    // replaces the record with st's roll number; false if there is none
+    // or a new name does not fit (see add)
+    bool update(const Student& st)
+    {
+        LatencyScope timed((size_t)RegistryOp::Update);
+        load_pending();
+        uint32_t slot = index.find(st.get_roll_no());
+        if (slot == RollIndex::npos)
+        {
+            return false;
+        }
+        // make room for a new name before changing anything
+        std::string name = st.get_name();
+        bool renamed = name != name_pool.view(names[slot]);
+        if (renamed && !name_room(name.size()))
+        {
+            return false;
+        }
+        int old_total = row_total(slot);
+        int old_marks[4], new_marks[4];
+        for (int k = 0; k < 4; k++)
+        {
+            old_marks[k] = marks[k][slot];
+            new_marks[k] = marks[k][slot] = st.get_marks(k);
+        }
+        stats_stale = true;
+        if (!summary_valid.empty())
+        {
+            summary_valid[slot] = 0;
+        }
+        if (aggregates.size())
+        {
+            aggregates.update(rolls[slot], old_marks, new_marks);
+        }
+        if (!indexes_stale && row_total(slot) != old_total)
+        {
+            by_total.erase(old_total, rolls[slot]);
+            by_total.insert(row_total(slot), rolls[slot]);
+        }
+        if (renamed)
+        {
+            if (!indexes_stale)
+            {
+                by_name.erase(name_pool.view(names[slot]), rolls[slot]);
+            }
+            name_pool.release(names[slot]);
+            name_pool.append(name, names[slot]);
+            if (!indexes_stale)
+            {
+                by_name.insert(names[slot], rolls[slot]);
+            }
+            collect_names();
+        }
+        return true;
+    }
+
+    bool remove(int roll_no)
+    {
+        LatencyScope timed((size_t)RegistryOp::Delete);
+        load_pending();
+        uint32_t slot = index.find(roll_no);
+        if (slot == RollIndex::npos)
+        {
+            return false;
+        }
+        index.erase(roll_no);
+        stats_stale = true;
+        if (aggregates.size())
+        {
+            int row_marks[4] = {marks[0][slot], marks[1][slot], marks[2][slot], marks[3][slot]};
+            aggregates.erase(roll_no, row_marks);
+        }
+        if (!indexes_stale)
+        {
+            by_name.erase(name_pool.view(names[slot]), roll_no);
+            by_total.erase(row_total(slot), roll_no);
+        }
+        name_pool.release(names[slot]);
+        uint32_t last = (uint32_t)rolls.size() - 1;
+        if (slot == last)
+        {
+            pop_row();
+        }
+        else if (mode == DeleteMode::SwapRemove)
+        {
+            move_row(last, slot);
+            index.assign(rolls[slot], slot);
+            pop_row();
+        }
+        else
+        {
+            clear_row(slot);
+            live[slot] = 0;
+            dead++;
+            if (dead > rolls.size() / 2)
+            {
+                compact();
+            }
+        }
+        collect_names();
+        return true;
+    }
+
+    // squeezes out tombstones, keeping the order of live records
+    void compact()
+    {
+        load_pending();
+        if (dead == 0)
+        {
+            return;
+        }
+        uint32_t out = 0;
+        for (uint32_t i = 0; i < rolls.size(); i++)
+        {
+            if (!live[i])
+            {
+                continue;
+            }
+            if (out != i)
+            {
+                move_row(i, out);
+                index.assign(rolls[out], out);
+            }
+            out++;
+        }
+        rolls.resize(out);
+        for (std::vector<int>& col : marks)
+        {
+            col.resize(out);
+        }
+        names.resize(out);
+        live.assign(out, 1);
+        if (!summary_valid.empty())
+        {
+            summaries.resize(out);
+            summary_valid.resize(out);
+        }
+        dead = 0;
+        compact_names();
+    }
+
+    // dense views of the mark columns for the analytics kernels; squeezes
+    // out tombstones first so every row is a live student
+    MarkColumns mark_columns()
+    {
+        compact();
+        return MarkColumns{{marks[0].data(), marks[1].data(), marks[2].data(), marks[3].data()},
+                           rolls.size()};
+    }
+
+    // one student's total, percentage, mean and variance; computed on
+    // first request and kept until the row is updated or removed
+    bool summary(int roll_no, MarkSummary& out)
+    {
+        load_pending();
+        uint32_t slot = index.find(roll_no);
+        if (slot == RollIndex::npos)
+        {
+            return false;
+        }
+        if (summary_valid.empty())
+        {
+            summaries.resize(rolls.size());
+            summary_valid.assign(rolls.size(), 0);
+        }
+        if (!summary_valid[slot])
+        {
+            int row_marks[4] = {marks[0][slot], marks[1][slot], marks[2][slot], marks[3][slot]};
+            summaries[slot] = summarize_marks(row_marks, 4);
+            summary_valid[slot] = 1;
+        }
+        out = summaries[slot];
+        return true;
+    }
+
+    // per-column and total distributions, recomputed only after a change
+    const ClassStatistics& statistics()
+    {
+        if (stats_stale)
+        {
+            class_statistics(mark_columns(), stats);
+            stats_stale = false;
+        }
+        return stats;
+    }
+
+    // number of students with a mark outside [low, high]
+    size_t count_out_of_range(TaskPool& pool, int low = 0, int high = 100)
+    {
+        MarkColumns m = mark_columns();
+        return pool.parallel_reduce(m.n, bulk_grain, (size_t)0, [&](size_t begin, size_t end)
+        {
+            size_t bad = 0;
+            for (size_t i = begin; i < end; i++)
+            {
+                bool out = false;
+                for (int k = 0; k < 4; k++)
+                {
+                    out |= m.col[k][i] < low || m.col[k][i] > high;
+                }
+                bad += out;
+            }
+            return bad;
+        }, [](size_t a, size_t b) { return a + b; });
+    }
+
+    // out[i] = total of the i-th student in display order; out has size()
+    // entries
+    void totals(TaskPool& pool, int* out)
+    {
+        MarkColumns m = mark_columns();
+        pool.parallel_for(m.n, bulk_grain, [&](size_t, size_t begin, size_t end)
+        {
+            student_totals(chunk_of(m, begin, end), out + begin);
+        });
+    }
+
+    // counts[b] = students whose total, as a percentage of max_total, is
+    // in band b; counts has bands.size() entries
+    void grade_counts(TaskPool& pool, const GradeBands& bands, size_t* counts, int max_total = 400)
+    {
+        MarkColumns m = mark_columns();
+        std::vector<size_t> sum = pool.parallel_reduce(m.n, bulk_grain, std::vector<size_t>(bands.size()),
+            [&](size_t begin, size_t end)
+            {
+                float percent[bulk_grain];
+                std::vector<size_t> chunk(bands.size());
+                student_percentages(chunk_of(m, begin, end), percent, max_total);
+                bands.count(percent, end - begin, chunk.data());
+                return chunk;
+            },
+            [](std::vector<size_t> a, const std::vector<size_t>& b)
+            {
+                for (size_t i = 0; i < a.size(); i++)
+                {
+                    a[i] += b[i];
+                }
+                return a;
+            });
+        std::copy(sum.begin(), sum.end(), counts);
+    }
+
+    // the same listing as a ReportWriter fed every row in order, with the
+    // chunks formatted in parallel; a window of a few chunks per thread is
+    // buffered at a time. false if the output failed
+    bool write_report(TaskPool& pool, int fd, ReportFormat format)
+    {
+        compact();
+        size_t n = rolls.size();
+        size_t window = bulk_grain * 4 * pool.threads();
+        std::vector<std::string> parts(TaskPool::chunk_count(std::min(n, window), bulk_grain));
+        ReportWriter out(fd, format);
+        for (size_t first = 0; first < n; first += window)
+        {
+            size_t rows = std::min(window, n - first);
+            pool.parallel_for(rows, bulk_grain, [&](size_t chunk, size_t begin, size_t end)
+            {
+                ReportWriter part(-1, format);
+                part.continue_after(first + begin);
+                for (size_t i = first + begin; i < first + end; i++)
+                {
+                    int row_marks[4] = {marks[0][i], marks[1][i], marks[2][i], marks[3][i]};
+                    part.row(rolls[i], row_marks, name_pool.view(names[i]));
+                }
+                parts[chunk] = part.take();
+            });
+            for (size_t c = 0; c < TaskPool::chunk_count(rows, bulk_grain); c++)
+            {
+                if (!out.write_formatted(parts[c]))
+                {
+                    return false;
+                }
+            }
+        }
+        return out.flush();
+    }
+
+    // registers an aggregate over the current and all future records and
+    // returns its id
+    size_t define_aggregate(const AggregateSpec& spec)
+    {
+        load_pending();
+        return aggregates.define(spec, [&](auto f) { visit_rows(f); });
+    }
+
+    // see MaterializedAggregates::value; O(1) except right after the
+    // extreme of a Min or Max aggregate was deleted
+    long long aggregate(size_t id) const
+    {
+        load_pending();
+        return aggregates.value(id, [&](auto f) { visit_rows(f); });
+    }
+
+    double aggregate_mean(size_t id) const
+    {
+        load_pending();
+        return aggregates.mean(id);
+    }
+
+    long long aggregate_count(size_t id) const
+    {
+        load_pending();
+        return aggregates.count(id);
+    }
+
+    const std::vector<long long>& aggregate_histogram(size_t id) const
+    {
+        load_pending();
+        return aggregates.histogram(id);
+    }
+
+    const int* roll_numbers()
+    {
+        compact();
+        return rolls.data();
+    }
+
+    // drops every record
+    void clear()
+    {
+        pending.reset();
+        rolls.clear();
+        for (std::vector<int>& col : marks)
+        {
+            col.clear();
+        }
+        names.clear();
+        name_pool.clear();
+        live.clear();
+        summaries.clear();
+        summary_valid.clear();
+        dead = 0;
+        index.clear();
+        by_name.clear();
+        by_total.clear();
+        indexes_stale = false;
+        stats_stale = true;
+        aggregates.reset();
+    }
+
+    // stops maintaining the secondary indexes until the next query that
+    // needs them, which rebuilds them from the columns
+    void defer_indexes()
+    {
+        indexes_stale = true;
+        by_name.clear();
+        by_total.clear();
+    }
+
+    // replaces the contents with a mapped snapshot without decoding it
+    void attach(std::shared_ptr<const SnapshotView> view)
+    {
+        clear();
+        pending = std::move(view);
+    }
+
+    // writes every live record to path atomically
+    bool save(const std::string& path, std::string& error) const
+    {
+        load_pending();
+        SnapshotWriter writer;
+        if (!writer.open(path, size(), error))
+        {
+            return false;
+        }
+        for_each_row([&](int roll_no, const int* row_marks, std::string_view name)
+        {
+            writer.add(roll_no, row_marks, name);
+        });
+        return writer.commit(error);
+    }
+
+    // f(name, roll_no) for each student whose name starts with prefix, in
+    // name order; limit 0 means no limit
+    template <class F>
+    size_t find_by_prefix(std::string_view prefix, F f, size_t limit = 0) const
+    {
+        LatencyScope timed((size_t)RegistryOp::Search);
+        load_pending();
+        rebuild_indexes();
+        return by_name.prefix(prefix, f, limit);
+    }
+
+    // f(name, roll_no) for each student with low <= name < high
+    template <class F>
+    size_t find_by_name_range(std::string_view low, std::string_view high, F f, size_t limit = 0) const
+    {
+        load_pending();
+        rebuild_indexes();
+        return by_name.range(low, high, f, limit);
+    }
+
+    // competition rank by total (1 = best; equal totals share a rank),
+    // or 0 if there is no such student
+    size_t rank_of(int roll_no) const
+    {
+        load_pending();
+        uint32_t slot = index.find(roll_no);
+        if (slot == RollIndex::npos)
+        {
+            return 0;
+        }
+        rebuild_indexes();
+        return by_total.count_above(row_total(slot)) + 1;
+    }
+
+    // f(roll_no, total) for the k best totals, best first; ties go to the
+    // lower roll number
+    template <class F>
+    void top_by_total(size_t k, F f) const
+    {
+        LatencyScope timed((size_t)RegistryOp::Top);
+        load_pending();
+        rebuild_indexes();
+        by_total.top(k, [&](int total, int roll_no) { f(roll_no, total); });
+    }
+
+    // the k-th best total (0-based)
+    bool kth_by_total(size_t k, int& roll_no, int& total) const
+    {
+        load_pending();
+        rebuild_indexes();
+        return by_total.kth(k, total, roll_no);
+    }
+
+    // median total; the mean of the two middle totals for an even count
+    double median_total() const
+    {
+        size_t n = size();
+        if (n == 0)
+        {
+            return 0.0;
+        }
+        int roll_no, hi = 0, lo = 0;
+        kth_by_total((n - 1) / 2, roll_no, hi);
+        kth_by_total(n / 2, roll_no, lo);
+        return (hi + lo) / 2.0;
+    }
+
+    // visits every record in display order
+    template <class F>
+    void for_each(F f) const
+    {
+        load_pending();
+        Student st;
+        for (size_t i = 0; i < rolls.size(); i++)
+        {
+            if (live[i])
+            {
+                load_row(i, st);
+                f(st);
+            }
+        }
+    }
+
+    // like for_each but hands out the columns directly, without building
+    // a Student: f(roll_no, const int marks[4], std::string_view name)
+    template <class F>
+    void for_each_row(F f) const
+    {
+        load_pending();
+        for (size_t i = 0; i < rolls.size(); i++)
+        {
+            if (live[i])
+            {
+                int row_marks[4] = {marks[0][i], marks[1][i], marks[2][i], marks[3][i]};
+                f(rolls[i], (const int*)row_marks, name_pool.view(names[i]));
+            }
+        }
+    }
+
+private:
+    DeleteMode mode;
+    std::vector<int> rolls;
+    std::vector<int> marks[4];
+    std::vector<NameRef> names;
+    NamePool name_pool;
+    std::vector<unsigned char> live;
+    // empty until the first summary(), then one entry per row
+    std::vector<MarkSummary> summaries;
+    std::vector<unsigned char> summary_valid;
+    size_t dead = 0;
+    RollIndex index;
+    NameIndex by_name{name_pool};
+    RankTree by_total;
+    bool indexes_stale = false;
+    ClassStatistics stats;
+    bool stats_stale = true;
+    MaterializedAggregates aggregates;
+    std::shared_ptr<const SnapshotView> pending;
+
+    // add() without the timing, for snapshot decoding
+    bool insert_row(std::string_view name, int roll_no, const int* row_marks)
+    {
+        if (!name_room(name.size()) || !index.insert(roll_no, (uint32_t)rolls.size()))
+        {
+            return false;
+        }
+        rolls.push_back(roll_no);
+        for (int k = 0; k < 4; k++)
+        {
+            marks[k].push_back(row_marks[k]);
+        }
+        names.emplace_back();
+        name_pool.append(name, names.back());
+        live.push_back(1);
+        if (!summary_valid.empty())
+        {
+            summaries.emplace_back();
+            summary_valid.push_back(0);
+        }
+        stats_stale = true;
+        if (aggregates.size())
+        {
+            aggregates.insert(roll_no, row_marks);
+        }
+        if (!indexes_stale)
+        {
+            by_name.insert(names.back(), roll_no);
+            by_total.insert(row_total(rolls.size() - 1), roll_no);
+        }
+        return true;
+    }
+
+    // decodes an attached snapshot into the columns; called by every
+    // accessor, so the registry is logically const while this runs
+    void load_pending() const
+    {
+        if (!pending)
+        {
+            return;
+        }
+        StudentRegistry* self = const_cast<StudentRegistry*>(this);
+        std::shared_ptr<const SnapshotView> view = std::move(self->pending);
+        self->pending.reset();
+        self->reserve(view->size());
+        self->name_pool.reserve(view->names_size());
+        self->defer_indexes();
+        for (size_t i = 0; i < view->size(); i++)
+        {
+            const SnapshotRecord& r = view->record(i);
+            self->insert_row(view->name(i), r.roll_no, r.marks);
+        }
+    }
+
+    void rebuild_indexes() const
+    {
+        if (!indexes_stale)
+        {
+            return;
+        }
+        StudentRegistry* self = const_cast<StudentRegistry*>(this);
+        std::vector<std::pair<NameRef, int>> pairs;
+        std::vector<std::pair<int, int>> totals;
+        pairs.reserve(size());
+        totals.reserve(size());
+        for (size_t i = 0; i < rolls.size(); i++)
+        {
+            if (live[i])
+            {
+                pairs.emplace_back(names[i], rolls[i]);
+                totals.emplace_back(row_total(i), rolls[i]);
+            }
+        }
+        self->by_name.assign(pairs);
+        self->by_total.assign(totals);
+        self->indexes_stale = false;
+    }
+
+    // f(roll_no, marks) for every live row
+    template <class F>
+    void visit_rows(F f) const
+    {
+        for (size_t i = 0; i < rolls.size(); i++)
+        {
+            if (live[i])
+            {
+                int row_marks[4] = {marks[0][i], marks[1][i], marks[2][i], marks[3][i]};
+                f(rolls[i], (const int*)row_marks);
+            }
+        }
+    }
+
+    static MarkColumns chunk_of(const MarkColumns& m, size_t begin, size_t end)
+    {
+        return MarkColumns{{m.col[0] + begin, m.col[1] + begin, m.col[2] + begin, m.col[3] + begin},
+                           end - begin};
+    }
+
+    int row_total(size_t slot) const
+    {
+        return marks[0][slot] + marks[1][slot] + marks[2][slot] + marks[3][slot];
+    }
+
+    void load_row(size_t slot, Student& out) const
+    {
+        int row_marks[4] = {marks[0][slot], marks[1][slot], marks[2][slot], marks[3][slot]};
+        out.set_data(std::string(name_pool.view(names[slot])), rolls[slot], row_marks);
+    }
+
+    void move_row(size_t from, size_t to)
+    {
+        rolls[to] = rolls[from];
+        for (std::vector<int>& col : marks)
+        {
+            col[to] = col[from];
+        }
+        names[to] = names[from];
+        live[to] = live[from];
+        if (!summary_valid.empty())
+        {
+            summaries[to] = summaries[from];
+            summary_valid[to] = summary_valid[from];
+        }
+    }
+
+    void clear_row(size_t slot)
+    {
+        rolls[slot] = 0;
+        for (std::vector<int>& col : marks)
+        {
+            col[slot] = 0;
+        }
+        names[slot] = NameRef();
+        if (!summary_valid.empty())
+        {
+            summary_valid[slot] = 0;
+        }
+    }
+
+    // rewrites the name pool without its dead bytes; the name index
+    // follows the names to their new offsets
+    void compact_names()
+    {
+        name_pool.compact(names);
+        if (!indexes_stale)
+        {
+            by_name.rebind([&](int roll_no) { return names[index.find(roll_no)]; });
+        }
+    }
+
+    // whether n more name bytes fit in the pool, compacting it first if
+    // they do not and there are dead bytes to reclaim
+    bool name_room(size_t n)
+    {
+        if (!name_pool.fits(n) && name_pool.dead_bytes() > 0)
+        {
+            compact_names();
+        }
+        return name_pool.fits(n);
+    }
+
+    // rewrites the name pool once dead bytes are the majority, so renames
+    // and deletes cost O(1) amortized
+    void collect_names()
+    {
+        if (name_pool.dead_bytes() > 4096 && name_pool.dead_bytes() > name_pool.bytes() / 2)
+        {
+            compact_names();
+        }
+    }
+
+    void pop_row()
+    {
+        rolls.pop_back();
+        for (std::vector<int>& col : marks)
+        {
+            col.pop_back();
+        }
+        names.pop_back();
+        live.pop_back();
+        if (!summary_valid.empty())
+        {
+            summaries.pop_back();
+            summary_valid.pop_back();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,260 @@
+// Work-stealing task pool for the registry's bulk jobs (validation,
+// totals, grade bands, formatted listings).
+//
+// parallel_for cuts [0, n) into chunks of grain items and deals each
+// participant a contiguous run of them on its own deque. A participant
+// pops its own chunks from the back and, once it runs dry, steals from
+// the front of someone else's, so a thread that drew cheap chunks helps
+// with the rest instead of idling. The calling thread is participant 0:
+// it runs chunks too and returns once every chunk has finished.
+//
+// parallel_reduce keeps one partial result per chunk and combines them in
+// chunk order, so the result never depends on which thread ran which
+// chunk. Chunk bodies must not throw.
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskPool
+{
+public:
+    // threads counts the caller; 0 means one per hardware thread
+    explicit TaskPool(size_t threads = 0)
+    {
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        count = threads;
+        queues.reset(new Queue[count]);
+        for (size_t i = 1; i < count; i++)
+        {
+            workers.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    ~TaskPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers)
+        {
+            t.join();
+        }
+    }
+
+    size_t threads() const
+    {
+        return count;
+    }
+
+    static size_t chunk_count(size_t n, size_t grain)
+    {
+        grain = std::max<size_t>(grain, 1);
+        return (n + grain - 1) / grain;
+    }
+
+    // f(chunk, begin, end) for each chunk of [0, n), in parallel
+    template <class F>
+    void parallel_for(size_t n, size_t grain, F f)
+    {
+        grain = std::max<size_t>(grain, 1);
+        size_t chunks = chunk_count(n, grain);
+        if (chunks == 0)
+        {
+            return;
+        }
+        if (chunks == 1 || count == 1)
+        {
+            for (size_t c = 0; c < chunks; c++)
+            {
+                f(c, c * grain, std::min(n, (c + 1) * grain));
+            }
+            return;
+        }
+
+        struct Body
+        {
+            F& f;
+            size_t n, grain;
+
+            static void run(void* self, size_t c)
+            {
+                Body& b = *static_cast<Body*>(self);
+                b.f(c, c * b.grain, std::min(b.n, (c + 1) * b.grain));
+            }
+        } body{f, n, grain};
+        Job job;
+        job.run = &Body::run;
+        job.body = &body;
+        job.remaining.store(chunks, std::memory_order_relaxed);
+
+        // participant q gets chunks [q * chunks / count, (q + 1) * chunks / count),
+        // pushed last first so its owner runs them in order
+        size_t self = participant();
+        pending.fetch_add(chunks, std::memory_order_seq_cst);
+        for (size_t q = 0; q < count; q++)
+        {
+            size_t first = q * chunks / count, last = (q + 1) * chunks / count;
+            Queue& queue = queues[(self + q) % count];
+            std::lock_guard<std::mutex> lock(queue.lock);
+            for (size_t c = last; c-- > first;)
+            {
+                queue.tasks.push_back(Task{&job, c});
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_lock);
+        }
+        wake.notify_all();
+
+        // help until the last chunk is done; chunks of other jobs count too
+        while (job.remaining.load(std::memory_order_acquire) != 0)
+        {
+            if (!run_one(self))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // combine(... combine(combine(identity, map(chunk 0)), map(chunk 1)) ...)
+    // where map(begin, end) reduces one chunk
+    template <class T, class Map, class Combine>
+    T parallel_reduce(size_t n, size_t grain, T identity, Map map, Combine combine)
+    {
+        std::vector<T> partial(chunk_count(n, grain), identity);
+        parallel_for(n, grain, [&](size_t chunk, size_t begin, size_t end)
+        {
+            partial[chunk] = map(begin, end);
+        });
+        T result = identity;
+        for (const T& p : partial)
+        {
+            result = combine(result, p);
+        }
+        return result;
+    }
+
+private:
+    struct Job
+    {
+        void (*run)(void* body, size_t chunk);
+        void* body;
+        std::atomic<size_t> remaining;
+    };
+
+    struct Task
+    {
+        Job* job;
+        size_t chunk;
+    };
+
+    // one cache line each, so owners and thieves of different deques never
+    // contend on the same line
+    struct alignas(64) Queue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    size_t count;
+    std::unique_ptr<Queue[]> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> pending{0};  // tasks queued and not yet taken
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // this thread's deque: its own for a worker of this pool, 0 otherwise
+    size_t participant() const
+    {
+        return current_pool() == this ? current_index() : 0;
+    }
+
+    static const TaskPool*& current_pool()
+    {
+        thread_local const TaskPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& current_index()
+    {
+        thread_local size_t index = 0;
+        return index;
+    }
+
+    // runs one task, from the back of our own deque or else stolen from
+    // the front of another; false if every deque was empty
+    bool run_one(size_t self)
+    {
+        Task task{nullptr, 0};
+        bool found = false;
+        {
+            Queue& own = queues[self];
+            std::lock_guard<std::mutex> lock(own.lock);
+            if (!own.tasks.empty())
+            {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                found = true;
+            }
+        }
+        for (size_t i = 1; i < count && !found; i++)
+        {
+            Queue& victim = queues[(self + i) % count];
+            std::lock_guard<std::mutex> lock(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            return false;
+        }
+        pending.fetch_sub(1, std::memory_order_relaxed);
+        task.job->run(task.job->body, task.chunk);
+        // the job may be gone once its last chunk is counted
+        task.job->remaining.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+
+    void work(size_t index)
+    {
+        current_pool() = this;
+        current_index() = index;
+        for (;;)
+        {
+            if (run_one(index))
+            {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_lock);
+            wake.wait(lock, [&] { return stopping || pending.load(std::memory_order_seq_cst) != 0; });
+            if (stopping)
+            {
+                return;
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,175 @@
+// Reading and splitting text input without copies, shared by the
+// registry's --batch load (batchingest.h) and the calculator's CSV input
+// (batchcalc.h).
+//
+// read_input() takes a whole file or stdin into one buffer; trim(),
+// parse_int() and split() then work on string_views into it, with numbers
+// parsed by std::from_chars.
+#ifndef TEXTINPUT_H
+#define TEXTINPUT_H
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// reads a file, or stdin for "-", into out in as few syscalls as possible
+inline bool read_input(const std::string& path, std::string& out, std::string& error)
+{
+    int fd = path == "-" ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    size_t chunk = 4 << 20;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+    {
+        chunk = (size_t)st.st_size + 1;
+    }
+    // a regular file fits with one byte to spare, so the read after it
+    // sees end of file without growing the buffer; it grows (doubling)
+    // only when a read fills it, i.e. for pipes or a file still growing
+    out.clear();
+    size_t used = 0;
+    while (true)
+    {
+        if (used == out.size())
+        {
+            out.resize(used + std::max(chunk, used));
+        }
+        ssize_t got = ::read(fd, &out[used], out.size() - used);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got < 0)
+        {
+            error = "read from " + path + " failed: " + std::strerror(errno);
+            if (fd != STDIN_FILENO)
+            {
+                ::close(fd);
+            }
+            return false;
+        }
+        if (got == 0)
+        {
+            break;
+        }
+        used += (size_t)got;
+    }
+    out.resize(used);
+    if (fd != STDIN_FILENO)
+    {
+        ::close(fd);
+    }
+    return true;
+}
+
+namespace batch_detail
+{
+
+inline std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+    {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+    {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+inline bool parse_int(std::string_view s, int& out)
+{
+    s = trim(s);
+    if (!s.empty() && s.front() == '+')
+    {
+        s.remove_prefix(1);
+    }
+    std::from_chars_result r = std::from_chars(s.data(), s.data() + s.size(), out);
+    return !s.empty() && r.ec == std::errc() && r.ptr == s.data() + s.size();
+}
+
+// splits line into at most max fields; a leading quoted field may contain
+// the delimiter, and its "" escapes are undone into scratch
+inline size_t split(std::string_view line, char delim, std::string_view* fields, size_t max,
+                    std::string& scratch, bool& bad_quote)
+{
+    size_t n = 0;
+    size_t pos = 0;
+    bad_quote = false;
+    std::string_view first = trim(line);
+    if (delim == ',' && !first.empty() && first.front() == '"')
+    {
+        size_t start = line.find('"') + 1;
+        size_t i = start;
+        bool escaped = false;
+        while (true)
+        {
+            size_t q = line.find('"', i);
+            if (q == std::string_view::npos)
+            {
+                bad_quote = true;
+                return 0;
+            }
+            if (q + 1 < line.size() && line[q + 1] == '"')
+            {
+                escaped = true;
+                i = q + 2;
+                continue;
+            }
+            std::string_view raw = line.substr(start, q - start);
+            if (escaped)
+            {
+                scratch.clear();
+                for (size_t k = 0; k < raw.size(); k++)
+                {
+                    scratch += raw[k];
+                    if (raw[k] == '"')
+                    {
+                        k++;
+                    }
+                }
+                raw = scratch;
+            }
+            fields[n++] = raw;
+            pos = line.find(delim, q + 1);
+            if (pos == std::string_view::npos)
+            {
+                return n;
+            }
+            pos++;
+            break;
+        }
+    }
+    while (true)
+    {
+        size_t end = line.find(delim, pos);
+        if (n == max)
+        {
+            return max + 1;
+        }
+        if (end == std::string_view::npos)
+        {
+            fields[n++] = line.substr(pos);
+            return n;
+        }
+        fields[n++] = line.substr(pos, end - pos);
+        pos = end + 1;
+    }
+}
+
+} // namespace batch_detail
+
+#endif
@@ -0,0 +1,517 @@
+// Write-ahead log of registry mutations.
+//
+// Layout (little-endian, version 1):
+//   WalHeader           16 bytes
+//   entries             WalRecord (32 bytes) followed by the name bytes
+//
+// Each entry carries a CRC-32 of everything after the checksum field, so
+// a torn write at the tail is detected on open and cut off; everything
+// before it is replayed.
+//
+// Group commit: appends go to an in-memory buffer and a flusher thread
+// writes and fdatasyncs the whole buffer once the oldest pending entry is
+// commit_ms old or commit_bytes are pending, so one sync covers every
+// mutation made in that window. Threads that need an entry on disk before
+// going on call wait_durable(), which returns with the next group sync.
+// With commit_ms 0 there is no flusher thread: appends are synced once
+// commit_bytes are pending, or one at a time if that is 0 too.
+//
+// The log sits on top of the last snapshot: after a snapshot is saved the
+// log is reset(). Replay applies each entry with apply_wal_entry(), which
+// treats adds and updates as "set this record" and deletes as "drop it",
+// so replaying a log over a snapshot that already contains some of its
+// effects (a crash between the two steps) still ends in the same state.
+#ifndef WAL_H
+#define WAL_H
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "student.h"
+
+static const char wal_magic[8] = {'S', 'T', 'U', 'D', 'W', 'A', 'L', '1'};
+static const uint32_t wal_version = 1;
+
+struct WalHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+enum class WalOp : uint8_t
+{
+    Add = 1,
+    Update = 2,
+    Delete = 3
+};
+
+struct WalRecord
+{
+    uint32_t checksum;
+    uint8_t op;
+    uint8_t pad[3];
+    int32_t roll_no;
+    int32_t marks[4];
+    uint32_t name_length;
+};
+
+static_assert(sizeof(WalHeader) == 16, "wal header must stay 16 bytes");
+static_assert(sizeof(WalRecord) == 32, "wal records must stay 32 bytes");
+
+// one decoded entry; name points into the log's read buffer
+struct WalEntry
+{
+    WalOp op;
+    int roll_no;
+    int marks[4];
+    std::string_view name;
+};
+
+struct WalOptions
+{
+    unsigned commit_ms = 5;           // longest an entry waits to be synced
+    size_t commit_bytes = 64 * 1024;  // sync early once this much is pending
+};
+
+inline uint32_t wal_crc32(const void* data, size_t n, uint32_t crc = 0)
+{
+    static const struct Table
+    {
+        uint32_t t[256];
+
+        Table()
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[i] = c;
+            }
+        }
+    } table;
+    const unsigned char* p = (const unsigned char*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++)
+    {
+        crc = table.t[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// applies a replayed entry to anything with the registry's add/update/
+// remove interface
+template <class Registry>
+inline void apply_wal_entry(Registry& registry, const WalEntry& e)
+{
+    if (e.op == WalOp::Delete)
+    {
+        registry.remove(e.roll_no);
+    }
+    else if (!registry.add(e.name, e.roll_no, e.marks))
+    {
+        registry.update(Student(std::string(e.name), e.roll_no, e.marks));
+    }
+}
+
+class WriteAheadLog
+{
+public:
+    WriteAheadLog() = default;
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    ~WriteAheadLog()
+    {
+        close();
+    }
+
+    // opens or creates the log at path, calls on_entry(const WalEntry&)
+    // for every intact entry in order, cuts off a torn tail and gets ready
+    // to append
+    template <class F>
+    bool open(const std::string& path, const WalOptions& opts, F on_entry, std::string& error)
+    {
+        close();
+        this->path = path;
+        options = opts;
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            error = "cannot open " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        std::string data;
+        if (!read_file(data))
+        {
+            error = "read from " + path + " failed: " + std::strerror(errno);
+            close();
+            return false;
+        }
+        if (data.size() < sizeof(WalHeader))
+        {
+            // new (or never fully initialised) log
+            if (!write_header())
+            {
+                error = "cannot initialise " + path + ": " + std::strerror(errno);
+                close();
+                return false;
+            }
+        }
+        else
+        {
+            WalHeader h;
+            std::memcpy(&h, data.data(), sizeof(h));
+            if (std::memcmp(h.magic, wal_magic, sizeof(wal_magic)) != 0)
+            {
+                error = path + " is not a student write-ahead log";
+                close();
+                return false;
+            }
+            if (h.version != wal_version)
+            {
+                error = path + " has unsupported log version " + std::to_string(h.version);
+                close();
+                return false;
+            }
+            size_t pos = sizeof(WalHeader);
+            WalEntry e;
+            while (decode(data, pos, e))
+            {
+                on_entry(e);
+                replayed++;
+            }
+            end = pos;
+            if (end != data.size() && (ftruncate(fd, (off_t)end) != 0 || fdatasync(fd) != 0))
+            {
+                error = "cannot trim the torn tail of " + path + ": " + std::strerror(errno);
+                close();
+                return false;
+            }
+        }
+        if (options.commit_ms > 0)
+        {
+            stopping = false;
+            flusher = std::thread([this] { flush_loop(); });
+        }
+        return true;
+    }
+
+    bool is_open() const
+    {
+        return fd >= 0;
+    }
+
+    // entries replayed by the last open()
+    size_t replayed_entries() const
+    {
+        return replayed;
+    }
+
+    // syncs what is pending and closes the file
+    void close()
+    {
+        if (fd < 0)
+        {
+            return;
+        }
+        sync();
+        if (flusher.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            flusher.join();
+        }
+        ::close(fd);
+        fd = -1;
+        pending.clear();
+        appended = durable = 0;
+        replayed = 0;
+        failed = false;
+    }
+
+    // logs one mutation and returns its sequence number for wait_durable;
+    // 0 if the log has failed. Safe to call from several threads.
+    uint64_t append(WalOp op, int roll_no, const int* marks, std::string_view name)
+    {
+        WalRecord r;
+        std::memset(&r, 0, sizeof(r));
+        r.op = (uint8_t)op;
+        r.roll_no = roll_no;
+        for (int k = 0; k < 4; k++)
+        {
+            r.marks[k] = marks ? marks[k] : 0;
+        }
+        r.name_length = (uint32_t)name.size();
+        r.checksum = wal_crc32((const char*)&r + sizeof(r.checksum), sizeof(r) - sizeof(r.checksum));
+        r.checksum = wal_crc32(name.data(), name.size(), r.checksum);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (failed)
+        {
+            return 0;
+        }
+        bool first = pending.empty();
+        if (first)
+        {
+            oldest = std::chrono::steady_clock::now();
+        }
+        pending.append((const char*)&r, sizeof(r));
+        pending.append(name.data(), name.size());
+        uint64_t seq = ++appended;
+        if (options.commit_ms == 0 && (options.commit_bytes == 0 || pending.size() >= options.commit_bytes))
+        {
+            write_pending(lock);
+        }
+        else if (first || (options.commit_bytes > 0 && pending.size() >= options.commit_bytes))
+        {
+            // starts the flusher's window, or cuts it short
+            wake.notify_one();
+        }
+        return failed ? 0 : seq;
+    }
+
+    // blocks until entry seq is on disk, at most one commit window plus
+    // the sync; false if the log failed
+    bool wait_durable(uint64_t seq)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return wait_for(lock, seq, false);
+    }
+
+    // makes every appended entry durable now
+    bool sync()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return wait_for(lock, appended, true) && !failed;
+    }
+
+    // empties the log once a snapshot holds its effects; no append may
+    // run concurrently
+    bool reset(std::string& error)
+    {
+        if (!sync())
+        {
+            error = "write to " + path + " failed";
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ftruncate(fd, (off_t)sizeof(WalHeader)) != 0 || fdatasync(fd) != 0)
+        {
+            error = "cannot reset " + path + ": " + std::strerror(errno);
+            failed = true;
+            return false;
+        }
+        end = sizeof(WalHeader);
+        return true;
+    }
+
+private:
+    std::string path;
+    WalOptions options;
+    int fd = -1;
+    size_t end = 0;      // file offset of the next write
+    size_t replayed = 0;
+
+    std::mutex mutex;
+    std::condition_variable wake;    // flusher: work or stop
+    std::condition_variable synced;  // waiters: durable moved
+    std::string pending;
+    std::chrono::steady_clock::time_point oldest;
+    uint64_t appended = 0;
+    uint64_t durable = 0;
+    bool flush_requested = false;
+    bool writing = false;
+    bool stopping = false;
+    bool failed = false;
+    std::thread flusher;
+
+    bool read_file(std::string& data)
+    {
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            return false;
+        }
+        data.resize((size_t)st.st_size);
+        size_t got = 0;
+        while (got < data.size())
+        {
+            ssize_t n = pread(fd, &data[got], data.size() - got, (off_t)got);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n < 0)
+            {
+                return false;
+            }
+            if (n == 0)
+            {
+                data.resize(got);
+                break;
+            }
+            got += (size_t)n;
+        }
+        return true;
+    }
+
+    bool write_header()
+    {
+        WalHeader h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, wal_magic, sizeof(wal_magic));
+        h.version = wal_version;
+        end = sizeof(h);
+        return ftruncate(fd, 0) == 0 && pwrite(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) &&
+               fsync(fd) == 0;
+    }
+
+    static bool decode(const std::string& data, size_t& pos, WalEntry& e)
+    {
+        WalRecord r;
+        if (data.size() - pos < sizeof(r))
+        {
+            return false;
+        }
+        std::memcpy(&r, data.data() + pos, sizeof(r));
+        if (r.name_length > data.size() - pos - sizeof(r) || r.op < 1 || r.op > 3)
+        {
+            return false;
+        }
+        const char* name = data.data() + pos + sizeof(r);
+        uint32_t crc = wal_crc32((const char*)&r + sizeof(r.checksum), sizeof(r) - sizeof(r.checksum));
+        if (wal_crc32(name, r.name_length, crc) != r.checksum)
+        {
+            return false;
+        }
+        e.op = (WalOp)r.op;
+        e.roll_no = r.roll_no;
+        for (int k = 0; k < 4; k++)
+        {
+            e.marks[k] = r.marks[k];
+        }
+        e.name = std::string_view(name, r.name_length);
+        pos += sizeof(r) + r.name_length;
+        return true;
+    }
+
+    bool wait_for(std::unique_lock<std::mutex>& lock, uint64_t seq, bool now)
+    {
+        if (durable >= seq || failed)
+        {
+            return durable >= seq;
+        }
+        if (!flusher.joinable())
+        {
+            write_pending(lock);
+            return durable >= seq;
+        }
+        if (now)
+        {
+            flush_requested = true;
+            wake.notify_one();
+        }
+        synced.wait(lock, [&] { return durable >= seq || failed; });
+        return durable >= seq;
+    }
+
+    // writes and syncs the pending buffer with the lock released, so
+    // appends keep queueing behind the sync; only one write runs at a time
+    void write_pending(std::unique_lock<std::mutex>& lock)
+    {
+        while (writing)
+        {
+            synced.wait(lock);
+        }
+        if (pending.empty() || failed)
+        {
+            return;
+        }
+        writing = true;
+        std::string batch;
+        batch.swap(pending);
+        uint64_t seq = appended;
+        size_t offset = end;
+        lock.unlock();
+
+        bool ok = true;
+        size_t done = 0;
+        while (ok && done < batch.size())
+        {
+            ssize_t n = pwrite(fd, batch.data() + done, batch.size() - done, (off_t)(offset + done));
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            ok = n > 0;
+            done += ok ? (size_t)n : 0;
+        }
+        ok = ok && fdatasync(fd) == 0;
+
+        lock.lock();
+        writing = false;
+        if (ok)
+        {
+            end = offset + batch.size();
+            durable = seq;
+            // hand the buffer back so its capacity is reused
+            if (pending.empty())
+            {
+                batch.clear();
+                pending.swap(batch);
+            }
+        }
+        else
+        {
+            failed = true;
+        }
+        synced.notify_all();
+    }
+
+    void flush_loop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            if (pending.empty())
+            {
+                flush_requested = false;
+                if (stopping)
+                {
+                    return;
+                }
+                wake.wait(lock);
+                continue;
+            }
+            std::chrono::steady_clock::time_point due = oldest + std::chrono::milliseconds(options.commit_ms);
+            bool full = options.commit_bytes > 0 && pending.size() >= options.commit_bytes;
+            if (!full && !flush_requested && !stopping && std::chrono::steady_clock::now() < due)
+            {
+                wake.wait_until(lock, due);
+                continue;
+            }
+            write_pending(lock);
+        }
+    }
+};
+
+#endif
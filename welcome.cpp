@@ -1,9 +1,17 @@
 #include<iostream>
+#include"demos.h"
 using namespace std;
-int main()
+int welcome_main(int, char**)
 {
     cout<<"Welcom in my first program"<<endl;
     cout<<"First code is to be started."<<endl;
     cout<<"Exit"<<endl;
     return 0;
-}
\ No newline at end of file
+}
+
+#ifndef DEMOS_NO_MAIN
+int main(int argc, char** argv)
+{
+    return welcome_main(argc, argv);
+}
+#endif